@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifndef BULK_FRAME_TIMEOUT_MS
+#define BULK_FRAME_TIMEOUT_MS 1000UL
+#endif
+
+/** Size of the static transfer buffer, one flash sector by default. */
+#ifndef BULK_BUFFER_SIZE
+#define BULK_BUFFER_SIZE 1024
+#endif
+
+/** Payload bytes the host may send ahead on a streamed write. */
+#ifndef BULK_STREAM_WINDOW
+#define BULK_STREAM_WINDOW 192
+#endif
+
+/** Payload bytes consumed per credit byte on a streamed write. */
+#ifndef BULK_STREAM_CREDIT
+#define BULK_STREAM_CREDIT 64
+#endif
+
+/** Binary bulk data frames carried on the RPC UART.
+ *
+ * simpleRPC stays in charge of control commands; bulk payloads follow a
+ * void RPC call as a raw frame:
+ *
+ *   [length: u16 LE][payload: length bytes][Fletcher-16: u16 LE]
+ *
+ * Host to device frames are answered with a single Status byte.
+ *
+ * A streamed write is a host to device frame paced by credits: the host
+ * sends up to BULK_STREAM_WINDOW payload bytes ahead and one more
+ * BULK_STREAM_CREDIT bytes for every CREDIT byte the device returns, so
+ * the UART keeps receiving while the device programs.
+ */
+namespace bulk {
+
+/** Flow control byte granting BULK_STREAM_CREDIT more payload bytes. */
+static constexpr uint8_t CREDIT = 0xCC;
+
+/** Statically allocated transfer buffer shared by buffered transfers. */
+extern uint8_t buffer[BULK_BUFFER_SIZE];
+
+enum class Status : uint8_t {
+  OK = 0,
+  ERR_CHECKSUM,
+  ERR_SIZE,
+  ERR_TIMEOUT,
+  ERR_TARGET,
+};
+
+/** Fletcher-16 (mod 255) running checksum. */
+class Checksum {
+ public:
+  void add(uint8_t byte) {
+    a_ += byte;
+    if (a_ >= 255) a_ -= 255;
+    b_ += a_;
+    if (b_ >= 255) b_ -= 255;
+  }
+
+  uint16_t value() const { return static_cast<uint16_t>(b_ << 8 | a_); }
+
+ private:
+  uint16_t a_ = 0;
+  uint16_t b_ = 0;
+};
+
+/** Outgoing frame, the header is sent on construction. */
+class Writer {
+ public:
+  explicit Writer(uint16_t length);
+
+  /** Send one payload byte. */
+  void put(uint8_t byte);
+
+  /** Send the checksum trailer. */
+  void finish();
+
+ private:
+  Checksum sum_;
+};
+
+/** Incoming frame. */
+class Reader {
+ public:
+  /** Wait for the frame header. @return false on timeout. */
+  bool begin();
+
+  /** Payload length from the header. */
+  uint16_t length() const { return length_; }
+
+  /** Receive one payload byte. @return false on timeout. */
+  bool get(uint8_t& byte);
+
+  /** Receive and check the trailer. @return true if the checksum matched. */
+  bool finish();
+
+  /** Discard the rest of the payload and the trailer. */
+  void skip();
+
+ private:
+  /** Receive a raw byte with timeout. */
+  bool raw(uint8_t& byte);
+
+  Checksum sum_;
+  uint16_t length_ = 0;
+  uint16_t received_ = 0;
+};
+
+/** Receive a whole frame into buffer. @p size is set to its length. */
+Status receive(uint16_t& size);
+
+/** Send a frame from memory. */
+void send(const uint8_t* data, uint16_t size);
+
+/** Send a single Status byte. */
+void send_status(Status status);
+
+/** Grant the host BULK_STREAM_CREDIT more payload bytes. */
+void send_credit();
+
+/** Schedule a UART baud rate change after the current RPC response.
+ * @return false if the rate is not supported.
+ */
+bool set_baud(uint32_t baud);
+
+/** Apply a scheduled baud rate change, call after each RPC is handled. */
+void poll();
+
+}  // namespace bulk
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/** Running CRC-32 (IEEE 802.3, reflected), identical to zlib.crc32.
+ *
+ * Uses a 16 entry nibble table in PROGMEM: 64 bytes of flash and two
+ * lookups per byte.
+ */
+class Crc32 {
+ public:
+  void add(uint8_t byte);
+
+  uint32_t value() const { return ~crc_; }
+
+ private:
+  uint32_t crc_ = 0xFFFFFFFFUL;
+};
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sinowealth/phy.h"
+
+#ifndef SINOJTAG_GANG
+#define SINOJTAG_GANG 0
+#endif
+
+/** Number of targets driven in gang mode. */
+#ifndef SINOJTAG_GANG_SITES
+#define SINOJTAG_GANG_SITES 4
+#endif
+
+/** Gang programming of identical targets over ICP.
+ *
+ * TCK, TMS and Vref are shared with the single target pin map on PORTD.
+ * Site n gets its own TDI on PBn (D8-D11) and TDO on PCn (A0-A3), so one
+ * port write drives every TDI and one port read samples every TDO per
+ * clock. All sites receive the same commands and data; results that can
+ * differ per site come back as site bitmasks or one value per site.
+ *
+ * JTAG is not supported in gang mode.
+ */
+namespace gang {
+
+static constexpr uint8_t SITES = SINOJTAG_GANG_SITES;
+static_assert(SITES >= 1 && SITES <= 4, "Gang mode supports 1 to 4 sites");
+
+/** Bitmask with a bit set for every site. */
+static constexpr uint8_t ALL = static_cast<uint8_t>((1u << SITES) - 1);
+
+/** Shared PHY for all sites, mirrors sinowealth::Phy. */
+class Phy {
+ public:
+  using Mode = sinowealth::Phy::Mode;
+
+  /** Run the diagnostic entry waveform on every site, timed by the active profile. */
+  void init(bool wait_vref = true);
+
+  /** Return all pins to High Z. */
+  void stop();
+
+  /** Switch every site to a new mode, only READY and ICP are supported. */
+  Mode mode(Mode mode);
+
+  /** Get current mode */
+  Mode mode() const { return _mode; }
+
+  /** Reset PHY to READY state */
+  Mode reset();
+
+ private:
+  template <typename Timing> void init(bool wait_vref);
+
+  Mode _mode = Mode::NOT_INITIALIZED;
+};
+
+/** ICP commands broadcast to every site, mirrors sinowealth::ICP. */
+class ICP {
+ public:
+  /** Init ICP mode (delay + ping) with the active timing profile. */
+  void init();
+
+  /** Send a byte to every site. */
+  void send_byte(uint8_t value);
+
+  /** Receive one byte per site into bytes[SITES]. */
+  void receive_byte(uint8_t* bytes);
+
+  /** Send ICP ping command. */
+  void ping();
+
+  /** Readback test. @return Mask of sites that answered. */
+  uint8_t verify();
+
+  /** Set the 16-bit flash address for subsequent operations. */
+  void set_address(uint16_t address);
+
+  /** Set address and issue READ_FLASH; follow with receive_byte() per byte. */
+  void begin_read(uint16_t address);
+
+  /** Program buffer on every site, runs of 0xFF are skipped. */
+  bool write_flash(uint16_t address, const uint8_t* buffer, uint16_t size);
+
+  /** Erase the sector at address. @return Mask of sites reporting success. */
+  uint8_t erase_flash(uint16_t address);
+
+ private:
+  template <typename Timing> void init();
+  template <typename Timing>
+  bool write_flash(uint16_t address, const uint8_t* buffer, uint16_t size);
+  template <typename Timing> uint8_t erase_flash(uint16_t address);
+};
+
+}  // namespace gang
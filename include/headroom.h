@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/** Free RAM low-water mark.
+ *
+ * paint() fills the gap between the heap and the stack with a pattern at
+ * boot. Heap Vectors grow into it from below and the deepest RPC call
+ * stack from above, so the longest run of untouched pattern bytes is the
+ * smallest margin left between them since boot.
+ */
+namespace headroom {
+
+/** Fill free RAM with the pattern, call first thing in setup(). */
+void paint();
+
+/** Longest run of painted bytes still untouched. @return Bytes. */
+uint16_t untouched();
+
+}  // namespace headroom
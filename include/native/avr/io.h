@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Native build stand-in for avr-libc's <avr/io.h>, see sim/register.h.
+
+#include <stdint.h>
+
+#include "sim/register.h"
+
+#define _BV(bit) (1 << (bit))
+
+#define PORTB sim::portb
+#define DDRB  sim::ddrb
+#define PINB  sim::pinb
+#define PORTC sim::portc
+#define DDRC  sim::ddrc
+#define PINC  sim::pinc
+#define PORTD sim::portd
+#define DDRD  sim::ddrd
+#define PIND  sim::pind
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace sim {
+
+/**
+ * Stand-in for an 8-bit AVR I/O register.
+ *
+ * Reads and writes go through optional hooks so the simulated target sees
+ * every pin change the firmware makes and supplies the input levels.
+ */
+class Register {
+ public:
+  using Read = uint8_t (*)(uint8_t value);
+  using Write = void (*)(uint8_t value);
+
+  constexpr Register(Read read = nullptr, Write write = nullptr)
+      : read_(read), write_(write) {}
+
+  operator uint8_t() const { return read_ ? read_(value_) : value_; }
+
+  Register& operator=(uint8_t value) {
+    value_ = value;
+    if (write_) write_(value);
+    return *this;
+  }
+
+  Register& operator|=(uint8_t mask) { return *this = value_ | mask; }
+  Register& operator&=(uint8_t mask) { return *this = value_ & mask; }
+  Register& operator^=(uint8_t mask) { return *this = value_ ^ mask; }
+
+  /** Last value written, without the read hook. */
+  uint8_t latch() const { return value_; }
+
+ private:
+  Read read_;
+  Write write_;
+  uint8_t value_ = 0;
+};
+
+extern Register portb, ddrb, pinb;
+extern Register portc, ddrc, pinc;
+extern Register portd, ddrd, pind;
+
+}  // namespace sim
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <SimpleJTAG/tap.h>
+
+namespace sim {
+
+/**
+ * Behavioral model of a SinoWealth 8051 on the far end of the pins.
+ *
+ * Follows the diagnostic entry waveform, the READY mode byte, the JTAG TAP
+ * with the IR/DR set the firmware uses and the ICP byte protocol, with a
+ * flash array behind both. Every TCK rising edge is counted so host code
+ * can be measured in clocks rather than wall time.
+ */
+class Target {
+ public:
+  enum class Mode : uint8_t { OFF, READY, JTAG, ICP };
+
+  static constexpr uint8_t BANKS = 2;
+  static constexpr uint16_t CUSTOM_SIZE = 256;
+  static constexpr uint16_t SECTOR_SIZE = 1024;
+  static constexpr uint16_t IDCODE = 0xF1A3;
+  static constexpr double ERASE_NS = 20e6;  // TDO held low while erasing
+
+  uint8_t flash[BANKS][0x10000];
+  uint8_t custom[CUSTOM_SIZE];
+
+  /** Pull TDO low while erasing, false models a part that never does. */
+  bool signal_busy = true;
+
+  Target();
+
+  /** Sample new pin levels after a port write. */
+  void drive(bool tck, bool tms, bool tdi);
+
+  /** Level the target drives on TDO. */
+  bool tdo() const;
+
+  Mode mode() const { return mode_; }
+
+  /** TCK rising edges since construction. */
+  uint32_t cycles() const { return cycles_; }
+
+ private:
+  using State = SimpleJTAG::Tap::State;
+
+  enum class Icp : uint8_t {
+    COMMAND,   // Waiting for a command byte
+    OPERAND,   // Byte for the command in command_
+    OUTPUT,    // Sending bytes until the host sends a nonzero one
+    UNLOCK,    // Counting PREAMBLE bytes
+    WRITE,     // Data byte of a (data, 0x00) pair
+    STROBE,    // 0x00 of a pair, anything else terminates the write
+    ERASE,     // Byte that starts the erase
+  };
+
+  void rising(bool tms, bool tdi);
+  void enter_ready();
+  void jtag_clock(bool tms, bool tdi);
+  uint8_t dr_bits() const;
+  uint64_t dr_capture() const;
+  void dr_update();
+  void icp_clock(bool tdi);
+  void icp_byte(uint8_t byte);
+  void icp_command(uint8_t byte);
+  uint8_t icp_next();
+  uint8_t& cell(uint16_t address);
+
+  bool tck_ = false;
+  bool tms_ = false;
+  Mode mode_ = Mode::OFF;
+  uint32_t cycles_ = 0;
+  uint16_t entry_pulses_ = 0;  // TMS rising edges with TCK high while OFF
+
+  // READY
+  uint16_t mode_packet_ = 0;
+  uint8_t mode_bits_ = 0;
+
+  // JTAG
+  State state_ = State::TestLogicReset;
+  uint8_t tms_run_ = 0;
+  uint8_t ir_ = 0;
+  uint8_t ir_shift_ = 0;
+  uint64_t dr_shift_ = 0;
+  uint8_t codescan_data_ = 0xFF;
+  bool tdo_ = true;
+
+  // ICP
+  Icp icp_ = Icp::COMMAND;
+  uint8_t bit_ = 0;
+  uint8_t in_ = 0;
+  uint8_t out_ = 0xFF;
+  uint8_t command_ = 0;
+  uint8_t output_count_ = 0;
+  uint8_t unlock_ = 0;
+  uint8_t preamble_ = 0;
+  uint16_t address_ = 0;
+  uint8_t data_ = 0;
+  uint8_t bank_ = 0;
+  bool custom_ = false;
+  double busy_until_ = 0;
+};
+
+extern Target target;
+
+}  // namespace sim
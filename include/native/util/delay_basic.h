@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Native build stand-in for <util/delay_basic.h>, loops cost F_CPU cycles
+// of simulated time like the AVR versions.
+
+#include <stdint.h>
+
+#include "sim/time.h"
+
+static inline void _delay_loop_1(uint8_t count) {
+  sim::elapse((count ? count : 256) * 3 * (1e9 / F_CPU));
+}
+
+static inline void _delay_loop_2(uint16_t count) {
+  sim::elapse((count ? count : 65536) * 4.0 * (1e9 / F_CPU));
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "bulk.h"
+#include "session.h"
+#include "sinowealth/icp.h"
+#include "sinowealth/tap.h"
+
+/** Request frame bytes the host may have outstanding, must fit the UART
+ * receive buffer since requests queue there while one executes. */
+#ifndef PIPELINE_WINDOW
+#define PIPELINE_WINDOW BULK_STREAM_WINDOW
+#endif
+
+/** Tagged request pipeline, entered by the pipeline_run RPC.
+ *
+ * Every request and response is a bulk frame whose payload starts with
+ * a sequence ID chosen by the host:
+ *
+ *   request:  [seq: u8][op: u8][operands]
+ *   response: [seq: u8][status: u8][result]
+ *
+ * Requests run in order, each as soon as the previous one finished, with
+ * multi-byte fields little-endian:
+ *
+ *   END                                Leave the pipeline, answered first
+ *   ICP_READ   address:u16 length:u16  Result is the flash bytes, at most
+ *                                      65533 so the frame length fits u16
+ *   ICP_WRITE  address:u16 data        Program with blank runs skipped
+ *   ICP_ERASE  address:u16             Result is the erase time, ms:u16
+ *   ICP_CRC    address:u16 length:u32  Result is the CRC-32 of the range
+ *   TAP_BATCH  program                 Result is scan::run's status byte
+ *                                      and captures, see scan.h
+ *
+ * The host keeps up to PIPELINE_WINDOW bytes of request frames in flight.
+ * Those wait in the UART receive buffer while the target is busy, and
+ * responses drain from the interrupt driven transmit buffer while the next
+ * request runs, so link and target work overlap. The held session keeps
+ * ICP or JTAG mode entered between requests and switches when a request
+ * needs the other one.
+ *
+ * A frame that fails its checksum is answered with seq 0xFF and ERR_FRAME
+ * and ends the pipeline, as does no request within BULK_FRAME_TIMEOUT_MS.
+ */
+namespace pipeline {
+
+enum Op : uint8_t {
+  END       = 0x00,
+  ICP_READ  = 0x01,
+  ICP_WRITE = 0x02,
+  ICP_ERASE = 0x03,
+  ICP_CRC   = 0x04,
+  TAP_BATCH = 0x05,
+};
+
+enum class Status : uint8_t {
+  OK = 0,
+  ERR_OPCODE,     // Unknown op
+  ERR_TRUNCATED,  // Request ends inside its operands
+  ERR_TARGET,     // Target not attached or the operation failed
+  ERR_FRAME,      // Request frame damaged, the pipeline ends
+};
+
+/** Sequence ID of responses to frames that could not be decoded. */
+static constexpr uint8_t SEQ_NONE = 0xFF;
+
+/** Execute request frames from the UART until END, an error or a timeout. */
+void run(Session& session, sinowealth::Tap& tap, sinowealth::ICP& icp);
+
+}  // namespace pipeline
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/** Cycle counters per firmware phase on Timer1, 0 compiles them out. */
+#ifndef SINOJTAG_PROFILE
+#define SINOJTAG_PROFILE 0
+#endif
+
+/** Hot-path profiling.
+ *
+ * A Scope charges the CPU cycles between its construction and destruction
+ * to a phase. Time spent in a nested Scope goes to the inner phase only, so
+ * the phases add up to the time spent inside any of them and RPC is left
+ * with the simpleRPC decode/dispatch/encode overhead.
+ *
+ * Per-byte phases (ICP_READ, BULK_IO) count one call per byte and include
+ * the Scope's own overhead of roughly 100 cycles.
+ *
+ * With SINOJTAG_PROFILE off Scope is empty and Timer1 is left alone.
+ */
+namespace profile {
+
+enum class Phase : uint8_t {
+  PHY_INIT,   // Entry waveform, after Vref is up
+  PHY_RESET,
+  PHY_MODE,
+  ICP_INIT,   // Includes the ICP init delay
+  ICP_READ,   // Per byte
+  ICP_WRITE,
+  ICP_ERASE,  // Includes the erase wait
+  TAP_IR,
+  TAP_DR,
+  BULK_IO,    // Per frame byte, includes waiting on the UART
+  RPC,        // Whole call, less the nested phases
+  COUNT
+};
+
+struct Counter {
+  uint32_t cycles;
+  uint32_t calls;
+};
+
+#if SINOJTAG_PROFILE
+
+/** Start Timer1 free running at F_CPU. */
+void init();
+
+/** Cycles since init(), wraps after 2^32 (~268 s at 16 MHz). */
+uint32_t now();
+
+/** Zero every counter. */
+void reset();
+
+const Counter& counter(Phase phase);
+
+class Scope {
+ public:
+  explicit Scope(Phase phase);
+  ~Scope();
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  Phase phase_;
+  Scope* parent_;
+  uint32_t start_;
+  uint32_t nested_ = 0;  // Cycles already charged to inner scopes
+};
+
+#else
+
+inline void init() {}
+
+class Scope {
+ public:
+  explicit Scope(Phase) {}
+};
+
+#endif
+
+}  // namespace profile
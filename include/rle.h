@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/** Run-length codec for flash data on the bulk link.
+ *
+ * PackBits style, each op is a control byte c followed by:
+ *  @li c < 0x80: a literal, c + 1 bytes follow (1-128)
+ *  @li c >= 0x80: a run, the next byte repeats (c & 0x7F) + 3 times (3-130)
+ *
+ * Erased 0xFF space and 0x00 padding shrink 65:1, and incompressible data
+ * grows by one byte in 128.
+ */
+namespace rle {
+
+static constexpr uint8_t RUN = 0x80;
+static constexpr uint8_t MAX_LITERAL = 128;
+static constexpr uint8_t MIN_RUN = 3;
+static constexpr uint8_t MAX_RUN = 130;
+
+/** Most bytes a single put() or flush() adds to the output. */
+static constexpr uint8_t MAX_GROWTH = 4;
+
+/** Streaming encoder into a caller-owned buffer. */
+class Encoder {
+ public:
+  explicit Encoder(uint8_t* out) : out_(out) {}
+
+  void put(uint8_t byte);
+
+  /** Emit the pending run, size() then covers every byte put. */
+  void flush();
+
+  /** Start over at the beginning of the buffer. */
+  void reset() {
+    size_ = 0;
+    literal_ = 0;
+    run_ = 0;
+  }
+
+  uint16_t size() const { return size_; }
+
+ private:
+  void emit_run();
+  void literal(uint8_t byte);
+
+  uint8_t* out_;
+  uint16_t size_ = 0;
+  uint16_t control_ = 0;  // Control byte of the open literal
+  uint8_t literal_ = 0;   // Bytes in the open literal, 0 if none
+  uint8_t value_ = 0;     // Byte of the pending run
+  uint8_t run_ = 0;       // Length of the pending run
+};
+
+/** Walk an encoded buffer.
+ * @param literal Called with each literal byte.
+ * @param run Called with (value, count) for each run.
+ * @return false if the buffer ends inside an op.
+ */
+template <typename Literal, typename Run>
+bool decode(const uint8_t* in, uint16_t size, Literal literal, Run run) {
+  uint16_t n = 0;
+  while (n < size) {
+    const uint8_t control = in[n++];
+    if (control & RUN) {
+      if (n >= size) return false;
+      run(in[n++], static_cast<uint8_t>((control & ~RUN) + MIN_RUN));
+      continue;
+    }
+
+    const uint16_t count = control + 1;
+    if (size - n < count) return false;
+    for (uint16_t i = 0; i < count; ++i) literal(in[n++]);
+  }
+  return true;
+}
+
+}  // namespace rle
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "sinowealth/tap.h"
+
+/** Batched TAP scan programs, run in one RPC call.
+ *
+ * A program is a sequence of ops, each an opcode byte and its operands,
+ * multi-byte operands little-endian:
+ *
+ *   RESET                         Test-Logic-Reset
+ *   GOTO     state:u8             Tap::goto_state
+ *   IDLE     count:u8             Tap::idle_clocks
+ *   IR       value:u8             Tap::IR
+ *   DR       bits:u8 value:bits   Tap::DR, value is ceil(bits / 8) bytes
+ *   CODESCAN address:u16          Read one flash byte via CODESCAN
+ *
+ * IR and DR or'd with CAPTURE append the captured value to the results in
+ * the same width as the value sent; CODESCAN always appends its data byte.
+ */
+namespace scan {
+
+enum Op : uint8_t {
+  RESET    = 0x01,
+  GOTO     = 0x02,
+  IDLE     = 0x03,
+  IR       = 0x04,
+  DR       = 0x05,
+  CODESCAN = 0x06,
+
+  CAPTURE  = 0x80,
+};
+
+enum class Status : uint8_t {
+  OK = 0,
+  ERR_OPCODE,     // Unknown opcode or operand out of range
+  ERR_TRUNCATED,  // Program ends inside an op
+  ERR_OVERFLOW,   // Captures exceed the result buffer
+};
+
+/** Run a program against tap, captures go to out.
+ * Stops at the first error; the captures made until then are kept.
+ * @param[out] written Number of result bytes stored.
+ */
+Status run(sinowealth::Tap& tap, const uint8_t* program, uint16_t size,
+           uint8_t* out, uint16_t capacity, uint16_t& written);
+
+}  // namespace scan
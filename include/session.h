@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "sinowealth/phy.h"
+#include "sinowealth/tap.h"
+#include "sinowealth/icp.h"
+
+#ifndef SESSION_TIMEOUT_MS
+#define SESSION_TIMEOUT_MS 1000UL
+#endif
+
+/** Tracks the active SinoWealth mode across RPC calls.
+ *
+ * Without an open session every operation enters its mode from READY and
+ * releases back to READY, as before. While a session is open the mode is
+ * kept between calls and only re-entered when it changes, or re-pinged
+ * when the link has been idle longer than SESSION_TIMEOUT_MS.
+ */
+class Session {
+ public:
+  Session(sinowealth::Phy& phy, sinowealth::Tap& tap, sinowealth::ICP& icp)
+      : phy_(phy), tap_(tap), icp_(icp) {}
+
+  /** Hold the active mode between calls. @return PHY is initialized. */
+  bool open();
+
+  /** Drop the held mode and return the PHY to READY. */
+  void close();
+
+  /** Return true while a session is held open. */
+  bool is_open() const { return held_; }
+
+  /** Ensure ICP mode with a live link. @return false if PHY not initialized. */
+  bool icp();
+
+  /** Ensure JTAG mode with an initialized TAP. @return Tap::init() status. */
+  sinowealth::Status jtag();
+
+  /** End of an operation; returns to READY unless a session is open. */
+  void release();
+
+ private:
+  /** True if the PHY is still in the mode this session entered. */
+  bool linked(sinowealth::Phy::Mode mode) const {
+    return linked_ && phy_.mode() == mode;
+  }
+
+  /** True if the link has been idle longer than SESSION_TIMEOUT_MS. */
+  bool expired() const;
+
+  /** Record link activity for the watchdog. */
+  void touch();
+
+  sinowealth::Phy& phy_;
+  sinowealth::Tap& tap_;
+  sinowealth::ICP& icp_;
+
+  bool held_ = false;
+  bool linked_ = false;
+  sinowealth::Status jtag_status_ = sinowealth::Status::OK;
+  uint32_t last_ms_ = 0;
+};
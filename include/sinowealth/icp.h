@@ -20,12 +20,21 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "sinowealth/timing.h"
+
 namespace sinowealth {
 
 class ICP {
  public:
-  /** Init ICP mode (800µs delay + ping). */
+  /** Flash block addressed by reads, write sequences and erases. */
+  enum class Block : uint8_t {
+    MAIN = 0,    // Code flash, banked by XPAGE on parts above 64K
+    CUSTOM = 1,  // Custom block holding the option bytes
+  };
+
+  /** Init ICP mode (delay + ping) with the active timing profile. */
   void init();
+  template <typename Timing> void init();
 
   /** Transition from ICP to DIAG state (TCK high, TMS pulse). */
   void exit();
@@ -45,14 +54,54 @@ class ICP {
   /** Set the 16-bit flash address for subsequent operations. */
   void set_address(uint16_t address);
 
+  /** Select the XPAGE bank of main flash for following commands, 0 is the first 64K. */
+  void set_bank(uint8_t bank);
+
+  /** Set address and issue READ_FLASH (or READ_CUSTOM); follow with receive_byte() per byte. */
+  void begin_read(uint16_t address, Block block = Block::MAIN);
+
   /** Read flash memory into buffer. */
   void read_flash(uint16_t address, uint8_t* buffer, size_t size);
 
-  /** Write flash memory from buffer. Enters ICP mode internally. Does NOT reset. */
-  bool write_flash(uint16_t address, const uint8_t* buffer, uint16_t size);
-
-  /** Erase flash sector at address. Enters/exits ICP mode internally. */
-  bool erase_flash(uint16_t address);
+  /** Start a write sequence at address with its first data byte. */
+  void begin_write(uint16_t address, uint8_t first);
+
+  /** Write the next data byte of a sequence started by begin_write(). */
+  void write_byte(uint8_t byte);
+  template <typename Timing> void write_byte(uint8_t byte);
+
+  /** Terminate a write sequence. */
+  void end_write();
+  template <typename Timing> void end_write();
+
+  /**
+   * Write flash memory from buffer. Enters ICP mode internally. Does NOT reset.
+   * With skip_blank, runs of BLANK_RUN or more 0xFF bytes are not clocked out
+   * and the sequence restarts at the next programmed byte.
+   */
+  bool write_flash(uint16_t address, const uint8_t* buffer, uint16_t size,
+                   bool skip_blank = false);
+  template <typename Timing>
+  bool write_flash(uint16_t address, const uint8_t* buffer, uint16_t size,
+                   bool skip_blank = false);
+
+  /** True if length bytes from address all read 0xFF, stops at the first that doesn't. */
+  bool blank_check(uint16_t address, uint32_t length);
+
+  /**
+   * Erase flash sector at address. Enters/exits ICP mode internally.
+   * Polls TDO for completion, the time waited in ms goes to duration_ms.
+   * The templated forms use the given timing profile instead of the active one.
+   */
+  bool erase_flash(uint16_t address, uint16_t* duration_ms = nullptr);
+  template <typename Timing>
+  bool erase_flash(uint16_t address, uint16_t* duration_ms = nullptr);
+
+  /** Flash erase block size, write sequences are kept within one block. */
+  static constexpr uint16_t SECTOR_SIZE = 1024;
+
+  /** Shortest 0xFF run worth ending and restarting a write sequence for. */
+  static constexpr uint16_t BLANK_RUN = 8;
 
   struct CommandSet {
     static constexpr uint8_t SET_IB_OFFSET_L = 0x40;
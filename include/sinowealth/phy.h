@@ -18,6 +18,8 @@
 
 #include <SimpleJTAG/phy.h>
 
+#include "sinowealth/timing.h"
+
 namespace sinowealth {
 
 class Phy : public SimpleJTAG::Phy {
@@ -30,9 +32,18 @@ class Phy : public SimpleJTAG::Phy {
   };
 
   /**Initialize the JTAG interface for SinoWealth 8051 MCUs
-   * Emits special waveforms out JTAG pins that enables JTAG on the target MCU
+   * Emits special waveforms out JTAG pins that enables JTAG on the target MCU,
+   * timed by the active profile unless one is given.
    */
   void init(bool wait_vref = true);
+  template <typename Timing> void init(bool wait_vref = true);
+
+  /**Take over a target assumed to already be in diagnostic mode
+   * Drives the READY line state without the entry waveform; the caller has to
+   * probe the link and fall back to init() if the target doesn't answer.
+   * @return false if Vref is absent
+   */
+  bool resume();
 
   /**Resets state to NOT_INITIALIZED and return GPIOs to High Z */
   void stop();
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <util/delay.h>
+
+#include "sinowealth/icp.h"
+
+/**
+ * Waveforms and ICP command sequences shared by the single target path and
+ * gang mode. Each is templated on a timing profile and on the type that
+ * carries it, so gang mode broadcasts them through its port-wide pin
+ * writers instead of keeping a copy.
+ */
+namespace sinowealth::sequence {
+
+/**
+ * Diagnostic mode entry waveform. Lines has static tck(), tms() and tdi()
+ * level setters for pins already switched to outputs.
+ * @post READY: TCK high, TMS low.
+ */
+template <typename Timing, typename Lines>
+void entry() {
+  Lines::tck(true);
+  Lines::tdi(true);
+  Lines::tms(true);
+
+  _delay_us(Timing::ENTRY_SETTLE_US);
+  Lines::tck(false);
+  _delay_us(Timing::ENTRY_EDGE_US);
+  Lines::tck(true);
+  _delay_us(Timing::ENTRY_HOLD_US);
+
+  for (uint8_t n = 0; n < Timing::ENTRY_TMS; ++n) {
+    Lines::tms(false);
+    _delay_us(Timing::ENTRY_STEP_US);
+    Lines::tms(true);
+    _delay_us(Timing::ENTRY_STEP_US);
+  }
+
+  for (uint8_t n = 0; n < Timing::ENTRY_TDI; ++n) {
+    Lines::tdi(false);
+    _delay_us(Timing::ENTRY_STEP_US);
+    Lines::tdi(true);
+    _delay_us(Timing::ENTRY_STEP_US);
+  }
+
+  for (uint8_t n = 0; n < Timing::ENTRY_TCK; ++n) {
+    Lines::tck(false);
+    _delay_us(Timing::ENTRY_STEP_US);
+    Lines::tck(true);
+    _delay_us(Timing::ENTRY_STEP_US);
+  }
+
+  for (uint16_t n = 0; n < Timing::ENTRY_TMS_TRAIN; ++n) {
+    Lines::tms(false);
+    _delay_us(Timing::ENTRY_STEP_US);
+    Lines::tms(true);
+    _delay_us(Timing::ENTRY_STEP_US);
+  }
+
+  _delay_us(Timing::ENTRY_EXIT_US);
+  Lines::tms(false);
+}
+
+using CommandSet = ICP::CommandSet;
+
+/** Start a write sequence at address, Link has send_byte() and set_address(). */
+template <typename Link>
+void begin_write(Link& link, uint16_t address, uint8_t first) {
+  link.set_address(address);
+
+  link.send_byte(CommandSet::SET_IB_DATA);
+  link.send_byte(first);
+
+  // Write unlock sequence
+  link.send_byte(CommandSet::WRITE_UNLOCK);
+  for (auto b : CommandSet::PREAMBLE) {
+    link.send_byte(b);
+  }
+}
+
+/** Write the next data byte of a sequence started by begin_write(). */
+template <typename Timing, typename Link>
+void write_byte(Link& link, uint8_t byte) {
+  // Data bytes after the first with inter-byte delay
+  link.send_byte(byte);
+  _delay_us(Timing::WRITE_BYTE_US);
+  link.send_byte(0x00);
+}
+
+/** Terminate a write sequence. */
+template <typename Timing, typename Link>
+void end_write(Link& link) {
+  // Write termination sequence
+  for (auto b : CommandSet::WRITE_TERM) {
+    link.send_byte(b);
+  }
+  _delay_us(Timing::WRITE_TERM_US);
+}
+
+/**
+ * Program buffer from address. With skip_blank, runs of ICP::BLANK_RUN or
+ * more 0xFF bytes are not clocked out and the sequence restarts at the next
+ * programmed byte.
+ */
+template <typename Timing, typename Link>
+bool write(Link& link, uint16_t address, const uint8_t* buffer, uint16_t size,
+           bool skip_blank) {
+  if (size == 0) {
+    return false;
+  }
+
+  bool writing = false;
+  for (uint16_t n = 0; n < size; ++n) {
+    if (skip_blank && buffer[n] == 0xFF) {
+      uint16_t run = 1;
+      while (n + run < size && buffer[n + run] == 0xFF) ++run;
+
+      // Erased flash already reads 0xFF, short runs inside a sequence are
+      // cheaper to write than a restart.
+      if (!writing || run >= ICP::BLANK_RUN || n + run == size) {
+        if (writing) {
+          end_write<Timing>(link);
+          writing = false;
+        }
+        n += run - 1;
+        continue;
+      }
+    }
+
+    if (writing) {
+      write_byte<Timing>(link, buffer[n]);
+    } else {
+      begin_write(link, address + n, buffer[n]);
+      writing = true;
+    }
+  }
+  if (writing) {
+    end_write<Timing>(link);
+  }
+
+  return true;
+}
+
+/**
+ * Wait for an erase started by the last ERASE_UNLOCK sequence byte. tdo()
+ * returns a mask of the sites whose TDO reads high, all has every site set.
+ *
+ * TDO is low while a site erases and goes high once it finishes. High only
+ * counts after that site was seen busy: an undriven TDO reads high through
+ * the pull-up, so a site that never signals busy gets the full fixed wait.
+ * A timeout falls through to the same status read the fixed wait used.
+ * @return Milliseconds waited.
+ */
+template <typename Timing, typename Sample>
+uint16_t wait_erase(Sample tdo, uint8_t all) {
+  uint8_t busy = 0;
+  uint16_t elapsed = 0;
+  while (elapsed < Timing::ERASE_TIMEOUT_MS) {
+    const uint8_t high = tdo() & all;
+    busy |= static_cast<uint8_t>(~high & all);
+    if (busy == all && high == all) break;
+    _delay_ms(1);
+    ++elapsed;
+  }
+  return elapsed;
+}
+
+}  // namespace sinowealth::sequence
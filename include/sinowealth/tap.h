@@ -21,6 +21,8 @@
 #include <stdint.h>
 #include <SimpleJTAG/tap.h>
 
+#include "profile.h"
+
 namespace sinowealth {
 
 namespace detail {
@@ -73,11 +75,35 @@ class Tap : public SimpleJTAG::Tap {
  public:
   Status init();
 
+  // Scans forward to SimpleJTAG::Tap inside a profile scope, the registers
+  // below all go through these.
+  template <typename T>
+  void IR(T out, T* in = nullptr) {
+    profile::Scope scope(profile::Phase::TAP_IR);
+    SimpleJTAG::Tap::IR(out, in);
+  }
+
+  template <int bits, typename T>
+  void DR(T out, T* in = nullptr) {
+    profile::Scope scope(profile::Phase::TAP_DR);
+    SimpleJTAG::Tap::DR<bits>(out, in);
+  }
+
+  void DR(uint32_t out, uint8_t bits, uint32_t* in = nullptr) {
+    profile::Scope scope(profile::Phase::TAP_DR);
+    SimpleJTAG::Tap::DR(out, bits, in);
+  }
+
+  void DR(const uint8_t* out, uint8_t* in, uint16_t bits) {
+    profile::Scope scope(profile::Phase::TAP_DR);
+    SimpleJTAG::Tap::DR(out, in, bits);
+  }
+
   // --- DEBUG register (IR=0x02, 4-bit DR) ---
   class DEBUG {
-    SimpleJTAG::Tap& tap_;
+    Tap& tap_;
    public:
-    DEBUG(SimpleJTAG::Tap& tap) : tap_(tap) {}
+    DEBUG(Tap& tap) : tap_(tap) {}
     static constexpr uint8_t HALT   = 0x01;
     static constexpr uint8_t ENABLE = 0x04;
     uint8_t operator()(uint8_t command);
@@ -85,9 +111,9 @@ class Tap : public SimpleJTAG::Tap {
 
   // --- CONFIG register (IR=0x03, 64-bit DR) ---
   class CONFIG {
-    SimpleJTAG::Tap& tap_;
+    Tap& tap_;
    public:
-    CONFIG(SimpleJTAG::Tap& tap) : tap_(tap) {}
+    CONFIG(Tap& tap) : tap_(tap) {}
     struct __attribute__((packed)) write_t {
       uint8_t address : 7;
       uint16_t data : 16;
@@ -113,9 +139,9 @@ class Tap : public SimpleJTAG::Tap {
   // --- CODESCAN register (IR=0x00, 30-bit DR) ---
   // Fields are MSB-first: [15:0]=addr, [21:16]=ctrl, [29:22]=data
   class CODESCAN {
-    SimpleJTAG::Tap& tap_;
+    Tap& tap_;
    public:
-    CODESCAN(SimpleJTAG::Tap& tap) : tap_(tap) {}
+    CODESCAN(Tap& tap) : tap_(tap) {}
     struct __attribute__((packed)) fields_t {
       uint16_t address : 16;
       uint8_t ctrl : 6;
@@ -125,13 +151,21 @@ class Tap : public SimpleJTAG::Tap {
     uint32_t operator()(uint32_t data);
     fields_t operator()(fields_t data);
     fields_t operator()(uint16_t address, uint8_t ctrl = READ);
+
+    /** Read length bytes from address with CODESCAN selected once.
+     * Data lags address by one scan, so each scan shifts in the next
+     * address while capturing the previous one's byte.
+     * @param put Called with each byte in address order.
+     */
+    template <typename Put>
+    void read(uint16_t address, uint16_t length, Put put);
   } CODESCAN{*this};
 
   // --- HALT register (IR=0x0C) ---
   class HALT {
-    SimpleJTAG::Tap& tap_;
+    Tap& tap_;
    public:
-    HALT(SimpleJTAG::Tap& tap) : tap_(tap) {}
+    HALT(Tap& tap) : tap_(tap) {}
     void operator()();
     void operator()(uint8_t opcode);
   } HALT{*this};
@@ -149,4 +183,43 @@ class Tap : public SimpleJTAG::Tap {
   };
 };
 
+template <typename Put>
+void Tap::CODESCAN::read(uint16_t address, uint16_t length, Put put) {
+    if (length == 0) return;
+
+    // Addresses go out MSB-first; keep the address bit-reversed and step it
+    // with a reversed increment instead of reversing every scan.
+    static constexpr uint32_t ctrl =
+        static_cast<uint32_t>(detail::bit_reverse_8(READ) >> 2) << 16;
+    uint16_t reversed = detail::bit_reverse_16(address);
+
+    // Scan word as little-endian bytes: address low/high, then ctrl
+    uint8_t scan[4] = {
+        static_cast<uint8_t>(reversed),
+        static_cast<uint8_t>(reversed >> 8),
+        static_cast<uint8_t>(ctrl >> 16),
+        0,
+    };
+    uint8_t raw[4];
+
+    tap_.IR(InstructionSet::CODESCAN);
+    tap_.DR(scan, nullptr, 30);  // Primes the pipeline
+
+    for (uint16_t n = 0; n < length; ++n) {
+        uint16_t bit = 0x8000;
+        while (reversed & bit) {
+            reversed ^= bit;
+            bit >>= 1;
+        }
+        reversed |= bit;
+        scan[0] = static_cast<uint8_t>(reversed);
+        scan[1] = static_cast<uint8_t>(reversed >> 8);
+
+        // Data sits in bits 29:22, i.e. bits 6-7 of byte 2 and 0-5 of byte 3
+        tap_.DR(scan, raw, 30);
+        const uint8_t data = static_cast<uint8_t>((raw[2] >> 6) | (raw[3] << 2));
+        put(detail::bit_reverse_8(data));
+    }
+}
+
 } // namespace sinowealth
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Upper bound for a sector erase, the historical fixed wait.
+#ifndef SINOWEALTH_ICP_ERASE_TIMEOUT_MS
+#define SINOWEALTH_ICP_ERASE_TIMEOUT_MS 300
+#endif
+
+namespace sinowealth::timing {
+
+/**
+ * Waveform timing for the diagnostic entry sequence and ICP commands.
+ *
+ * Delay-bearing Phy and ICP methods are templated on a profile so every
+ * delay stays a compile-time constant for _delay_us/_delay_ms.
+ */
+struct Conservative {
+  // Phy::init entry waveform
+  static constexpr uint16_t ENTRY_SETTLE_US = 500;  // Outputs high before the first edge
+  static constexpr uint8_t  ENTRY_EDGE_US   = 1;    // Initial TCK low pulse
+  static constexpr uint8_t  ENTRY_HOLD_US   = 50;   // After the initial TCK pulse
+  static constexpr uint8_t  ENTRY_STEP_US   = 2;    // Each half of an entry pulse
+  static constexpr uint8_t  ENTRY_EXIT_US   = 8;    // Before TMS is dropped to READY
+  static constexpr uint8_t  ENTRY_TMS       = 165;  // Pulse counts of each phase
+  static constexpr uint8_t  ENTRY_TDI       = 105;
+  static constexpr uint8_t  ENTRY_TCK       = 90;
+  static constexpr uint16_t ENTRY_TMS_TRAIN = 25600;
+
+  // ICP
+  static constexpr uint16_t ICP_INIT_US      = 800;  // TODO: Verify length of delay
+  static constexpr uint8_t  WRITE_BYTE_US    = 5;    // Between a data byte and its 0x00
+  static constexpr uint8_t  WRITE_TERM_US    = 5;    // After the termination sequence
+  static constexpr uint16_t ERASE_TIMEOUT_MS = SINOWEALTH_ICP_ERASE_TIMEOUT_MS;
+};
+
+/**
+ * Shortened delays, pulse counts are left alone since the target counts
+ * them. Parts that misbehave fall back to Conservative via phy_set_timing.
+ * The write delays stay conservative: the fallback check only reads, so a
+ * part that needs longer would be under-programmed without any error.
+ */
+struct Fast : Conservative {
+  static constexpr uint16_t ENTRY_SETTLE_US = 100;
+  static constexpr uint8_t  ENTRY_STEP_US   = 1;
+  static constexpr uint16_t ICP_INIT_US     = 200;
+};
+
+enum class Profile : uint8_t {
+  CONSERVATIVE = 0,
+  FAST = 1,
+  COUNT
+};
+
+/** Profile used by the non-templated Phy and ICP entry points. */
+inline Profile active = Profile::CONSERVATIVE;
+
+/** Call fn with a value of the active profile type. */
+template <typename Fn>
+inline auto dispatch(Fn&& fn) {
+  switch (active) {
+    case Profile::FAST: return fn(Fast{});
+    default: return fn(Conservative{});
+  }
+}
+
+}  // namespace sinowealth::timing
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <util/delay.h>
+#include <util/delay_basic.h>
+
+// TCK from Timer2 output compare on OC2B (PD3) instead of the bit loop
+#ifndef SIMPLEJTAG_TIMER_TCK
+#define SIMPLEJTAG_TIMER_TCK 0
+#endif
+
+#if SIMPLEJTAG_TIMER_TCK
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#endif
+
+namespace SimpleJTAG {
+
+/** TCK clock policies, passed as the Clock argument of Phy::stream_bits. */
+namespace clock {
+
+/** Fixed half-period in microseconds. */
+template <uint8_t US>
+struct Fixed {
+  static inline void delay_half() { _delay_us(US); }
+};
+
+/** No added delay, TCK rate is bounded by the bit loop alone. */
+struct Fast {
+  static inline void delay_half() {}
+};
+
+/** Half-period selectable at runtime in 3-cycle delay loop iterations. */
+struct Runtime {
+  /** ~1 µs half-period at 16 MHz F_CPU, matching Fixed<1>. */
+  static constexpr uint8_t DEFAULT_LOOPS = 5;
+
+  /** Delay loop iterations per half-period, 0 = no delay. */
+  static inline uint8_t loops = DEFAULT_LOOPS;
+
+  static inline void delay_half() {
+    // _delay_loop_1(0) would spin 256 times
+    if (loops) _delay_loop_1(loops);
+  }
+};
+
+/** True for policies whose TCK edges come from a hardware timer. */
+template <typename Clock>
+inline constexpr bool is_timer = false;
+
+#if SIMPLEJTAG_TIMER_TCK
+/**
+ * TCK generated by Timer2 toggling OC2B in CTC mode, so edges fall on
+ * exact timer cycles whatever code the compiler emits for the bit loop.
+ *
+ * The half-period is Runtime::loops * 3 CPU cycles, the delay loop's unit,
+ * so clock selection and calibration work unchanged. OCF2A fires a
+ * quarter into each phase. Each bit runs the timer from its setup through
+ * one full TCK period with interrupts held off, then pauses it with TCK
+ * low a quarter into the next low phase and restores interrupts for the
+ * loop body and the next setup. The timer never runs with interrupts on,
+ * so no tick can be missed; an ISR only stretches the paused low phase.
+ * The high phase is exact, the low phase is the half-period plus the
+ * paused time between bits.
+ */
+struct Timer2 : Runtime {
+  /**
+   * Worst case CPU cycles from OCF2A being set to the TDO sample or the
+   * pause: 4 for the sbis/rjmp poll to see it, 2 to clear it, 1 for the
+   * in/sts that follows, rounded up.
+   */
+  static constexpr uint8_t TICK_LATENCY = 8;
+
+  /**
+   * Shortest half-period in CPU cycles: the tick latency plus 50% margin
+   * still ends before the next edge, three quarters of a phase later.
+   */
+  static constexpr uint16_t MIN_HALF = 16;
+
+  /**
+   * Longest half-period in CPU cycles, bounding the interrupt blackout of
+   * one bit to 2 * MAX_HALF + TICK_LATENCY cycles (16.3 µs at 16 MHz).
+   * That is under two byte times at 1 Mbaud, the USART's receive FIFO
+   * depth, so the ISR-fed receive paths don't overrun.
+   */
+  static constexpr uint16_t MAX_HALF = 126;
+
+  static_assert(MIN_HALF - MIN_HALF / 4 >= TICK_LATENCY + TICK_LATENCY / 2,
+                "Tick latency must end before the next TCK edge");
+
+  /** Interrupt blackout per bit in CPU cycles at the longest half-period. */
+  static constexpr uint16_t MAX_BLACKOUT = 2 * MAX_HALF + TICK_LATENCY;
+
+  /** Largest Runtime::loops value, longer half-periods are clamped. */
+  static constexpr uint8_t MAX_LOOPS = MAX_HALF / 3;
+
+  /** Start or resume TCK with interrupts off, wait for the high phase tick. */
+  static inline void rise() {
+    sreg_ = SREG;
+    cli();
+    if (running_) {
+      TCCR2B = _BV(CS20);
+    } else {
+      start();
+    }
+    tick();
+  }
+
+  /** Wait for the low phase tick and pause TCK low, interrupts back on. */
+  static inline void fall() {
+    tick();
+    TCCR2B = 0;
+    SREG = sreg_;
+  }
+
+  /** Disconnect OC2B after the last bit, TCK stays low. */
+  static inline void stop() {
+    if (!running_) return;
+    TCCR2A = 0;  // OC2B disconnected, PORT holds TCK low
+    TIFR2 = _BV(OCF2A);
+    running_ = false;
+  }
+
+ private:
+  static inline void start() {
+    uint16_t half = loops * 3;
+    if (half < MIN_HALF) half = MIN_HALF;
+    if (half > MAX_HALF) half = MAX_HALF;
+
+    // CTC before the compare registers, they are double buffered in the
+    // PWM mode the Arduino core leaves Timer2 in
+    TCCR2B = 0;
+    TCCR2A = _BV(COM2B1) | _BV(WGM21);
+    OCR2A = static_cast<uint8_t>(half - 1);
+    OCR2B = static_cast<uint8_t>(half - 1 - half / 4);
+    TCNT2 = 0;
+
+    // Forced match clears OC2B, then each match toggles it
+    TCCR2B = _BV(FOC2B);
+    TCCR2A = _BV(COM2B0) | _BV(WGM21);
+    TIFR2 = _BV(OCF2A);
+    TCCR2B = _BV(CS20);
+    running_ = true;
+  }
+
+  static inline void tick() {
+    while (!(TIFR2 & _BV(OCF2A))) {}
+    TIFR2 = _BV(OCF2A);
+  }
+
+  static inline bool running_ = false;
+  static inline uint8_t sreg_ = 0;
+};
+
+template <>
+inline constexpr bool is_timer<Timer2> = true;
+#endif
+
+}  // namespace clock
+}  // namespace SimpleJTAG
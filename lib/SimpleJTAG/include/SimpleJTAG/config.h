@@ -21,18 +21,29 @@
 #include <stdint.h>
 #include <util/delay.h>
 
+#include "clock.h"
+
 namespace config {
 
+// Registers bind by auto&: volatile uint8_t on AVR, sim::Register objects in
+// the native build (include/native/avr/io.h).
 #define DEFINE_PIN(NAME, PORT_LETTER, BIT)                     \
   namespace NAME {                                             \
-    static inline volatile uint8_t& port = PORT##PORT_LETTER;  \
-    static inline volatile uint8_t& ddr = DDR##PORT_LETTER;    \
-    static inline volatile uint8_t& pin = PIN##PORT_LETTER;    \
+    static inline auto& port = PORT##PORT_LETTER;              \
+    static inline auto& ddr = DDR##PORT_LETTER;                \
+    static inline auto& pin = PIN##PORT_LETTER;                \
     static constexpr uint8_t index = BIT;                      \
+    static constexpr char port_letter = #PORT_LETTER[0];       \
   }
 
+#if SIMPLEJTAG_TIMER_TCK
+// TCK on OC2B (PD3) for clock::Timer2, TMS moves to PD5
+DEFINE_PIN(tck, D, 3);
+DEFINE_PIN(tms, D, 5);
+#else
 DEFINE_PIN(tck, D, 5);
 DEFINE_PIN(tms, D, 3);
+#endif
 DEFINE_PIN(tdi, D, 4);
 DEFINE_PIN(tdo, D, 2);
 DEFINE_PIN(vref, D, 6);
@@ -45,7 +56,15 @@ static constexpr uint8_t IR_BITS = 4;
 /** Enable pull-up on TDO input (set false if target drives push-pull). */
 static constexpr bool tdo_pullup = true;
 
-/** Delay half-period for TCK (~250 kHz at 16 MHz F_CPU). */
-static inline void delay_half() { _delay_us(1); }
+/** Default TCK clock policy, see SimpleJTAG/clock.h. */
+#if SIMPLEJTAG_TIMER_TCK
+using Clock = SimpleJTAG::clock::Timer2;
+static_assert(tck::port_letter == 'D' && tck::index == 3, "Timer2 drives TCK on OC2B (PD3)");
+#else
+using Clock = SimpleJTAG::clock::Runtime;
+#endif
+
+/** Delay half-period for TCK (~250 kHz at 16 MHz F_CPU by default). */
+static inline void delay_half() { Clock::delay_half(); }
 
 }  // namespace config
@@ -26,7 +26,12 @@
 
 namespace SimpleJTAG {
 
-/** Stateless JTAG PHY bit-banging implementation. */
+/**
+ * Stateless JTAG PHY bit-banging implementation.
+ *
+ * Pin helpers are templated on the register type, so the same code drives
+ * AVR I/O registers or the simulated ports of the native build.
+ */
 struct Phy {
   /**
    * @pre config::tck/tms/tdi/tdo pins are valid.
@@ -61,15 +66,19 @@ struct Phy {
    * @pre init() completed and JTAG pins configured.
    * @post One TCK pulse applied with given TMS.
    */
+  template <typename Clock = config::Clock>
   static inline void next_state(bool tms) {
-    write_port(config::tms::port, config::tms::index, tms);
-    pulse_tck();
+    (void)clock_bit<Clock>([tms] {
+      write_port(config::tms::port, config::tms::index, tms);
+    });
+    finish<Clock>();
   }
 
   /**
    * @pre init() completed; pins configured for JTAG.
    * @post Shifted bits LSB-first; optional capture stored in @p in.
    */
+  template <typename Clock = config::Clock>
   static inline uint32_t stream_bits(uint32_t out, uint8_t bits, bool exit,
                                      uint32_t *in = nullptr) {
     if (bits == 0) {
@@ -80,31 +89,24 @@ struct Phy {
     }
 
     uint32_t capture = 0;
+    uint32_t mask = 1;  // Shifts out to 0 past bit 31
     for (uint8_t i = 0; i < bits; ++i) {
-      // setup TMS and TDI
+      // setup TMS and TDI, clock them out and TDO in
       const bool is_last = (i + 1) == bits;
-      write_port(config::tms::port, config::tms::index, exit && is_last);
-      write_port(config::tdi::port, config::tdi::index, (out & 0x1u) != 0);
+      const bool tdo = clock_bit<Clock>([=] {
+        write_port(config::tms::port, config::tms::index, exit && is_last);
+        write_port(config::tdi::port, config::tdi::index, (out & 0x1u) != 0);
+      });
 
-      // clock out TMS and TDI
-      set_tck(false);
-      config::delay_half();
-
-      // Clock in TDO
-      set_tck(true);
-      config::delay_half();
-
-      // Read TDO
-      if (read_pin(config::tdo::pin, config::tdo::index)) {
-        if (i < 32) {
-          capture |= (1UL << i);
-        }
+      if (tdo) {
+        capture |= mask;
       }
 
-      // reset clock and advance bit
-      set_tck(false);
+      // advance bit
+      mask <<= 1;
       out >>= 1;
     }
+    finish<Clock>();
 
     if (in) {
       *in = capture;
@@ -113,28 +115,27 @@ struct Phy {
   }
 
   /** Convenience wrapper for compile-time-sized shifts. */
-  template <int N, bool EXIT, typename T>
+  template <int N, bool EXIT, typename T, typename Clock = config::Clock>
   static inline T stream_bits(T out, T *in = nullptr) {
     static_assert(N > 0, "stream_bits N must be >= 1");
 
     T capture = 0;
+    T mask = 1;
     for (uint8_t i = 0; i < N; ++i) {
       const bool is_last = (i + 1) == N;
-      write_port(config::tms::port, config::tms::index, EXIT && is_last);
-      write_port(config::tdi::port, config::tdi::index, (out & T(1)) != 0);
+      const bool tdo = clock_bit<Clock>([=] {
+        write_port(config::tms::port, config::tms::index, EXIT && is_last);
+        write_port(config::tdi::port, config::tdi::index, (out & T(1)) != 0);
+      });
 
-      set_tck(false);
-      config::delay_half();
-      set_tck(true);
-      config::delay_half();
-
-      if (read_pin(config::tdo::pin, config::tdo::index)) {
-        capture |= (T(1) << i);
+      if (tdo) {
+        capture |= mask;
       }
 
-      set_tck(false);
+      mask <<= 1;
       out >>= 1;
     }
+    finish<Clock>();
 
     if (in) {
       *in = capture;
@@ -142,8 +143,47 @@ struct Phy {
     return capture;
   }
 
+  /**
+   * Shift bits LSB-first from byte buffers, byte-at-a-time with 8-bit
+   * arithmetic only. A null @p out shifts zeros, a null @p in discards.
+   * The last partial byte of @p in holds its bits in the low end.
+   * @pre init() completed; pins configured for JTAG.
+   * @post TMS high on the final bit if @p exit.
+   */
+  template <typename Clock = config::Clock>
+  static inline void stream_bytes(const uint8_t* out, uint8_t* in,
+                                  uint16_t bits, bool exit) {
+    for (uint16_t n = 0; n < bits; n += 8) {
+      const uint8_t count = (bits - n) < 8 ? static_cast<uint8_t>(bits - n) : 8;
+      const bool last_byte = (n + count) == bits;
+      uint8_t tx = out ? out[n / 8] : 0;
+      uint8_t rx = 0;
+
+      for (uint8_t i = 0; i < count; ++i) {
+        const bool tdo = clock_bit<Clock>([=] {
+          write_port(config::tms::port, config::tms::index,
+                     exit && last_byte && (i + 1) == count);
+          write_port(config::tdi::port, config::tdi::index, (tx & 0x1u) != 0);
+        });
+
+        rx >>= 1;
+        if (tdo) {
+          rx |= 0x80;
+        }
+
+        tx >>= 1;
+      }
+
+      if (in) {
+        in[n / 8] = static_cast<uint8_t>(rx >> (8 - count));
+      }
+    }
+    finish<Clock>();
+  }
+
   /** Configure GPIO direction bit. */
-  static inline void set_ddr(volatile uint8_t& ddr, uint8_t bit, bool output) {
+  template <typename Reg>
+  static inline void set_ddr(Reg& ddr, uint8_t bit, bool output) {
     const uint8_t mask = static_cast<uint8_t>(1U << bit);
     if (output) {
       ddr |= mask;
@@ -153,7 +193,8 @@ struct Phy {
   }
 
   /** Write GPIO output bit. */
-  static inline void write_port(volatile uint8_t& port, uint8_t bit, bool value) {
+  template <typename Reg>
+  static inline void write_port(Reg& port, uint8_t bit, bool value) {
     const uint8_t mask = static_cast<uint8_t>(1U << bit);
     if (value) {
       port |= mask;
@@ -163,19 +204,45 @@ struct Phy {
   }
 
   /** Read GPIO input bit. */
-  static inline bool read_pin(volatile uint8_t& pin, uint8_t bit) {
+  template <typename Reg>
+  static inline bool read_pin(Reg& pin, uint8_t bit) {
     const uint8_t mask = static_cast<uint8_t>(1U << bit);
     return (pin & mask) != 0;
   }
 
  private:
-  /** Pulse TCK low->high->low with timing delays. */
-  static inline void pulse_tck() {
-    set_tck(false);
-    config::delay_half();
-    set_tck(true);
-    config::delay_half();
-    set_tck(false);
+  /**
+   * Clock one bit: @p setup drives TMS/TDI with TCK low, then TCK rises and
+   * TDO is returned as read in the high phase. Delay policies toggle TCK
+   * here, timer policies run the timer for the bit and pause it; either
+   * way the bit ends with TCK low and nothing due until the next call.
+   */
+  template <typename Clock, typename Setup>
+  static inline bool clock_bit(Setup setup) {
+    if constexpr (clock::is_timer<Clock>) {
+      setup();
+      Clock::rise();
+      const bool tdo = read_pin(config::tdo::pin, config::tdo::index);
+      Clock::fall();
+      return tdo;
+    } else {
+      setup();
+      set_tck(false);
+      Clock::delay_half();
+      set_tck(true);
+      Clock::delay_half();
+      const bool tdo = read_pin(config::tdo::pin, config::tdo::index);
+      set_tck(false);
+      return tdo;
+    }
+  }
+
+  /** End a shift, releasing a timer clock after its last bit. */
+  template <typename Clock>
+  static inline void finish() {
+    if constexpr (clock::is_timer<Clock>) {
+      Clock::stop();
+    }
   }
 
   /** Drive TCK output. */
@@ -62,6 +62,12 @@ class Tap {
   /** Force TAP to Test-Logic-Reset by holding TMS high for 5 clocks. */
   void reset();
 
+  /** Forget the latched instruction, the next IR() always scans.
+   * Call when something outside this class may have changed it, e.g. the
+   * target left and re-entered JTAG mode.
+   */
+  void invalidate_ir() { ir_valid_ = false; }
+
   /** Move the TAP to a target state using the shortest TMS sequence. */
   void goto_state(State target);
 
@@ -76,7 +82,9 @@ class Tap {
   uint32_t idcode();
 
   /** Shift an instruction register value and optionally capture output.
-   * @post state = Update-IR
+   * Skipped when the instruction is already latched and nothing is
+   * captured, the TAP then stays where it is.
+   * @post state = Update-IR, or unchanged if skipped
    */
   template <typename T>
   void IR(T out, T* in = nullptr);
@@ -87,6 +95,18 @@ class Tap {
   template <int bits, typename T>
   void DR(T out, T* in = nullptr);
 
+  /** Shift a data register value of a runtime bit width (1..32).
+   * @post state = Update-DR
+   */
+  void DR(uint32_t out, uint8_t bits, uint32_t* in = nullptr);
+
+  /** Shift a data register of any width from byte buffers, LSB-first.
+   * @p out and @p in hold (bits + 7) / 8 bytes and may be the same buffer
+   * or null.
+   * @post state = Update-DR
+   */
+  void DR(const uint8_t* out, uint8_t* in, uint16_t bits);
+
   /** Emit additional idle while keeping TMS low.
    * @warning Only stable in:
    *  @li Run-Test/Idle
@@ -108,10 +128,20 @@ class Tap {
   void step(bool tms) {
     Phy::next_state(tms);
     state_ = next_state(state_, tms);
+    if (state_ == State::TestLogicReset) ir_valid_ = false;
+  }
+
+  /** IR value masked to config::IR_BITS. */
+  static constexpr uint32_t ir_value(uint32_t value) {
+    return config::IR_BITS >= 32 ? value : value & ((1UL << config::IR_BITS) - 1);
   }
 
   /** Current tracked TAP state. */
   State state_;
+
+  /** Instruction latched by the last IR scan, valid until a reset. */
+  uint32_t ir_ = 0;
+  bool ir_valid_ = false;
 }; // class Tap
 
 template <int bits, typename T>
@@ -127,11 +157,18 @@ void Tap::DR(T out, T* in) {
 
 template <typename T>
 void Tap::IR(T out, T* in) {
+  const uint32_t value = ir_value(static_cast<uint32_t>(out));
+  if (!in && ir_valid_ && ir_ == value) {
+    return;
+  }
+
   goto_state(State::ShiftIR);
   Phy::stream_bits<config::IR_BITS, true>(out, in);
 
   state_ = State::Exit1IR;
   step(true); // State::UpdateIR
+  ir_ = value;
+  ir_valid_ = true;
 }
 
 
@@ -17,6 +17,92 @@
 
 #include "SimpleJTAG/tap.h"
 
+#include <avr/pgmspace.h>
+
+namespace {
+  using State = SimpleJTAG::Tap::State;
+
+  /** Shortest TMS path for every (from, to) state pair.
+   * Each entry packs the path length in bits 8-11, THROUGH_RESET in bit 15
+   * and the TMS bits, first clock in bit 0, in the low byte.
+   */
+  struct PathTable {
+    uint16_t entry[16][16];
+  };
+
+  /** Set when the path enters Test-Logic-Reset, which reloads IDCODE into IR. */
+  static constexpr uint16_t THROUGH_RESET = 0x8000;
+  static constexpr uint8_t LENGTH_MASK = 0x0F;
+
+  /** Breadth-first search over Tap::next_state. */
+  constexpr uint16_t shortest_path(uint8_t start, uint8_t goal) {
+    uint8_t queue[16] = {};
+    uint8_t prev[16] = {};
+    uint8_t prev_tms[16] = {};
+    bool visited[16] = {};
+
+    uint8_t head = 0;
+    uint8_t tail = 0;
+    visited[start] = true;
+    queue[tail++] = start;
+
+    while (head < tail && !visited[goal]) {
+      const uint8_t s = queue[head++];
+      for (uint8_t tms = 0; tms < 2; ++tms) {
+        const uint8_t ns = static_cast<uint8_t>(
+            SimpleJTAG::Tap::next_state(static_cast<State>(s), tms != 0));
+        if (!visited[ns]) {
+          visited[ns] = true;
+          prev[ns] = s;
+          prev_tms[ns] = tms;
+          queue[tail++] = ns;
+        }
+      }
+    }
+
+    // Walk back from the goal, the last clock ends up in the highest bit
+    uint8_t len = 0;
+    uint8_t bits = 0;
+    bool reset = false;
+    for (uint8_t cur = goal; cur != start; cur = prev[cur]) {
+      bits = static_cast<uint8_t>((bits << 1) | prev_tms[cur]);
+      reset = reset || cur == static_cast<uint8_t>(State::TestLogicReset);
+      ++len;
+    }
+    return static_cast<uint16_t>((reset ? THROUGH_RESET : 0) | (len << 8) | bits);
+  }
+
+  constexpr PathTable make_paths() {
+    PathTable table = {};
+    for (uint8_t from = 0; from < 16; ++from) {
+      for (uint8_t to = 0; to < 16; ++to) {
+        table.entry[from][to] = shortest_path(from, to);
+      }
+    }
+    return table;
+  }
+
+  constexpr PathTable paths PROGMEM = make_paths();
+
+  // Test-Logic-Reset -> Shift-IR is TMS 0, 1, 1, 0, 0
+  static_assert(paths.entry[0][11] == ((5 << 8) | 0b00110), "TAP path table");
+  constexpr bool fits_byte(const PathTable& table) {
+    for (uint8_t from = 0; from < 16; ++from) {
+      for (uint8_t to = 0; to < 16; ++to) {
+        if (((table.entry[from][to] >> 8) & LENGTH_MASK) > 8) return false;
+      }
+    }
+    return true;
+  }
+  static_assert(fits_byte(paths), "TAP paths must fit one byte of TMS");
+
+  // Select-IR -> Run-Test/Idle is TMS 1, 0 through Test-Logic-Reset
+  static_assert(paths.entry[static_cast<uint8_t>(State::SelectIRScan)]
+                           [static_cast<uint8_t>(State::RunTestIdle)] ==
+                    (THROUGH_RESET | (2 << 8) | 0b01),
+                "TAP path table");
+}
+
 namespace SimpleJTAG {
 
 Tap::Tap() : state_(State::TestLogicReset) {
@@ -35,19 +121,21 @@ void Tap::reset() {
     Phy::next_state(true);
   }
   state_ = State::TestLogicReset;
+  ir_valid_ = false;
 }
 
 /** Select IR=IDCODE then read 32 bits from DR. */
 uint32_t Tap::idcode() {
   uint32_t idcode;
   IR(InstructionSet::IDCODE);
-  DR<32>(0UL, &idcode);
+  DR<32>(uint32_t(0), &idcode);
   return idcode;
 }
 
 /** Select BYPASS by shifting all-ones into IR. */
 void Tap::bypass() {
   IR(InstructionSet::BYPASS);
+  ir_valid_ = false;
 }
 
 /** Move the TAP to a target state using the shortest TMS sequence. */
@@ -56,47 +144,37 @@ void Tap::goto_state(State target) {
     return;
   }
 
-  const uint8_t start = static_cast<uint8_t>(state_);
-  const uint8_t goal = static_cast<uint8_t>(target);
-
-  uint8_t queue[16];
-  uint8_t prev[16];
-  uint8_t prev_tms[16];
-  bool visited[16] = {false};
-
-  uint8_t head = 0;
-  uint8_t tail = 0;
-  visited[start] = true;
-  queue[tail++] = start;
-
-  while (head < tail && !visited[goal]) {
-    const uint8_t s = queue[head++];
-    for (uint8_t tms = 0; tms < 2; ++tms) {
-      const uint8_t ns =
-          static_cast<uint8_t>(next_state(static_cast<State>(s), tms != 0));
-      if (!visited[ns]) {
-        visited[ns] = true;
-        prev[ns] = s;
-        prev_tms[ns] = tms;
-        queue[tail++] = ns;
-      }
-    }
+  const uint16_t path = pgm_read_word(
+      &paths.entry[static_cast<uint8_t>(state_)][static_cast<uint8_t>(target)]);
+  uint8_t bits = static_cast<uint8_t>(path);
+  for (uint8_t len = (path >> 8) & LENGTH_MASK; len > 0; --len) {
+    Phy::next_state(bits & 0x1);
+    bits >>= 1;
   }
+  state_ = target;
+  if (path & THROUGH_RESET) ir_valid_ = false;
+}
+
+/** Shift a data register value of a runtime bit width (1..32). */
+void Tap::DR(uint32_t out, uint8_t bits, uint32_t* in) {
+  goto_state(State::ShiftDR);
+  Phy::stream_bits(out, bits, true, in);
+
+  state_ = State::Exit1DR;
+  step(true); // State::UpdateDR
+}
 
-  if (!visited[goal]) {
+/** Shift a data register of any width from byte buffers, LSB-first. */
+void Tap::DR(const uint8_t* out, uint8_t* in, uint16_t bits) {
+  if (bits == 0) {
     return;
   }
 
-  uint8_t seq[16];
-  uint8_t len = 0;
-  for (uint8_t cur = goal; cur != start; cur = prev[cur]) {
-    seq[len++] = prev_tms[cur];
-  }
+  goto_state(State::ShiftDR);
+  Phy::stream_bytes(out, in, bits, true);
 
-  while (len > 0) {
-    const bool tms = (seq[--len] != 0);
-    step(tms);
-  }
+  state_ = State::Exit1DR;
+  step(true); // State::UpdateDR
 }
 
 /** Emit additional idle while keeping TMS low.
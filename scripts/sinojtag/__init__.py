@@ -9,11 +9,18 @@ from .flash import (
     MAX_TRANSFER_SIZE,
     FlashDevice,
     FlashIO,
+    VerifyError,
 )
+from .pipeline import Pipeline
+from .scan import ScanProgram, TapState
 
 __all__ = [
     "ERASE_BLOCK_SIZE",
     "MAX_TRANSFER_SIZE",
     "FlashDevice",
     "FlashIO",
+    "Pipeline",
+    "ScanProgram",
+    "TapState",
+    "VerifyError",
 ]
@@ -2,12 +2,24 @@
 
 import argparse
 import sys
+import threading
 import time
+from collections.abc import Callable, Iterator
+from contextlib import contextmanager
 from dataclasses import dataclass
 from typing import cast
 
-from . import ihex
-from .flash import ERASE_BLOCK_SIZE, MAX_TRANSFER_SIZE, FlashIO
+from . import backup, bench, ihex, plan, station
+from .flash import (
+    BULK_BAUDRATE,
+    ERASE_BLOCK_SIZE,
+    FLASH_SIZE,
+    TIMING_PROFILES,
+    FlashDevice,
+    FlashIO,
+    VerifyError,
+)
+from .gang import GangDevice, SiteResult
 
 
 class _ProgressBar:
@@ -72,40 +84,138 @@ class _ProgressBar:
         )
 
 
+class _StationProgress:
+    """Combined progress of several programmers on one line, thread safe."""
+
+    def __init__(self, ports: list[str], size: int):
+        self._lock = threading.Lock()
+        self._written = dict.fromkeys(ports, 0)
+        self._size = size
+        self._start_time = time.perf_counter()
+        self._bar_width = 40
+
+    def update(self, port: str, count: int) -> None:
+        """Record bytes written through a port, called from worker threads."""
+        with self._lock:
+            self._written[port] += count
+            self._render()
+
+    def _render(self) -> None:
+        total = self._size * len(self._written)
+        current = sum(self._written.values())
+        done = sum(1 for n in self._written.values() if n >= self._size)
+        elapsed = time.perf_counter() - self._start_time
+        rate = current / elapsed if elapsed > 0 else 0
+
+        filled = (current * self._bar_width) // total if total else self._bar_width
+        bar = "#" * filled + "-" * (self._bar_width - filled)
+        percent = (current * 100) // total if total else 100
+        line = (
+            f"\rProgramming: [{bar}] {percent:3d}% {done}/{len(self._written)} written "
+            + f"({_ProgressBar._format_rate(rate)})"
+        )
+        _ = sys.stdout.write(line)
+        _ = sys.stdout.flush()
+
+    def finish(self) -> None:
+        """End the progress line."""
+        _ = sys.stdout.write("\n")
+
+
 @dataclass
-class _ReadArgs:
+class _LinkArgs:
     port: str
     baudrate: int
+    clock: str | None
+    bulk_baud: int
+    timing: str | None
+    profile: bool
+    compress: bool
+
+
+@dataclass
+class _ReadArgs:
+    link: _LinkArgs
     output: str
     address: int
     size: int
+    jtag: bool
 
 
 @dataclass
 class _EraseArgs:
-    port: str
-    baudrate: int
+    link: _LinkArgs
     address: int
     size: int
 
 
 @dataclass
 class _FlashArgs:
-    port: str
-    baudrate: int
+    link: _LinkArgs
     input: str
     address: int
     no_erase: bool
+    full: bool
     verify: bool
     format: str  # "auto", "ihex", or "binary"
 
 
+@dataclass
+class _GangArgs:
+    link: _LinkArgs
+    input: str
+    address: int
+    no_erase: bool
+    format: str  # "auto", "ihex", or "binary"
+
+
+@dataclass
+class _FlashManyArgs:
+    link: _LinkArgs
+    input: str
+    ports: list[str]
+    address: int
+    no_erase: bool
+    no_verify: bool
+    jobs: int | None
+    format: str  # "auto", "ihex", or "binary"
+
+
 @dataclass
 class _VerifyArgs:
-    port: str
-    baudrate: int
+    link: _LinkArgs
+    input: str
+    address: int
+
+
+@dataclass
+class _BackupArgs:
+    link: _LinkArgs
+    output: str
+    bank_size: int
+    banks: int
+    custom_size: int
+
+
+@dataclass
+class _RestoreArgs:
+    link: _LinkArgs
     input: str
+    verify: bool
+
+
+@dataclass
+class _BenchArgs:
+    link: _LinkArgs
+    operations: list[str]
+    sizes: list[int]
+    bauds: list[int]
+    clocks: list[int]
+    repeats: int
     address: int
+    no_target: bool
+    format: str  # "csv" or "json"
+    output: str | None
 
 
 def _parse_int(value: str) -> int:
@@ -113,68 +223,92 @@ def _parse_int(value: str) -> int:
     return int(value, 0)
 
 
-def _read_with_progress(flash: FlashIO, address: int, size: int, label: str) -> bytes:
-    """Read data from flash with progress bar display."""
+def _parse_ints(value: str) -> list[int]:
+    """Parse a comma separated list of integers."""
+    return [_parse_int(v) for v in value.split(",") if v]
+
+
+@contextmanager
+def _open(link: _LinkArgs) -> Iterator[FlashIO]:
+    """Open a FlashIO for the link settings given on the command line.
+
+    With --profile the firmware counters and RAM headroom are printed, and the
+    counters zeroed, on the way out.
+    """
+    with FlashIO(
+        link.port, link.baudrate, link.clock, link.bulk_baud, link.timing, link.compress
+    ) as flash:
+        if link.profile and not flash.has_stats:
+            print("Warning: firmware was built without SINOJTAG_PROFILE, no profile")
+        yield flash
+        if link.profile and flash.has_stats:
+            print(flash.stats().format())
+            flash.reset_stats()
+        if link.profile and (headroom := flash.headroom()) is not None:
+            print(f"RAM headroom: {headroom} bytes free between heap and stack since boot")
+
+
+def _read_with_progress(
+    flash: FlashIO, address: int, size: int, label: str, jtag: bool = False
+) -> bytes:
+    """Read data from flash with progress bar display, via CODESCAN if jtag."""
     progress = _ProgressBar(label, size, address)
     result = bytearray()
     current_addr = address
-    remaining = size
 
-    while remaining > 0:
-        chunk_size = min(remaining, MAX_TRANSFER_SIZE)
-        chunk = flash.read_chunk(current_addr, chunk_size)
-        if not chunk:
-            break
+    chunks = flash.codescan_read(address, size) if jtag else flash.read_stream(address, size)
+    for chunk in chunks:
         result.extend(chunk)
         current_addr += len(chunk)
-        remaining -= len(chunk)
         progress.update(len(chunk), current_addr)
 
     progress.finish()
     return bytes(result)
 
 
-def _write_with_progress(flash: FlashIO, address: int, data: bytes, label: str) -> int:
-    """Write data to flash with progress bar display."""
-    progress = _ProgressBar(label, len(data), address)
-    current_addr = address
-    total_written = 0
-
-    while total_written < len(data):
-        chunk = data[total_written : total_written + MAX_TRANSFER_SIZE]
-        written = flash.write_chunk(current_addr, chunk)
-        if written <= 0:
-            break
-        total_written += written
-        current_addr += written
-        progress.update(written, current_addr)
-
-    progress.finish()
-    return total_written
-
+def _erase_with_progress(
+    flash: FlashIO, address: int, size: int, label: str
+) -> tuple[int, int]:
+    """Erase flash blocks with progress bar display, skipping blank ones.
 
-def _erase_with_progress(flash: FlashIO, address: int, size: int, label: str) -> int:
-    """Erase flash blocks with progress bar display."""
+    Returns:
+        Tuple of (blocks erased, blank blocks skipped)
+    """
     start_block = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
     end_addr = address + size
     total_size = end_addr - start_block
+    total_blocks = (total_size + ERASE_BLOCK_SIZE - 1) // ERASE_BLOCK_SIZE
 
     progress = _ProgressBar(label, total_size, start_block)
-    blocks_erased = 0
+    durations: list[int] = []
+    current_addr = start_block
 
-    for addr in range(start_block, end_addr, ERASE_BLOCK_SIZE):
-        if flash.erase_block(addr):
-            blocks_erased += 1
-        progress.update(ERASE_BLOCK_SIZE, addr + ERASE_BLOCK_SIZE)
+    for run_addr, count in flash.dirty_runs(start_block, total_size):
+        # Blank blocks before this run were skipped
+        progress.update(run_addr - current_addr, run_addr)
+        durations.extend(flash.erase_blocks(run_addr, count))
+        current_addr = run_addr + count * ERASE_BLOCK_SIZE
+        progress.update(count * ERASE_BLOCK_SIZE, current_addr)
 
+    progress.update(start_block + total_blocks * ERASE_BLOCK_SIZE - current_addr, end_addr)
     progress.finish()
-    return blocks_erased
+    if any(durations):
+        print(f"Erase time {sum(durations)} ms, {max(durations)} ms slowest block")
+    return len(durations), total_blocks - len(durations)
+
+
+def _print_erased(erased: int, skipped: int) -> None:
+    """Report the outcome of _erase_with_progress()."""
+    if skipped:
+        print(f"Erased {erased} block(s), {skipped} already blank")
+    else:
+        print(f"Erased {erased} block(s)")
 
 
 def _cmd_read(args: _ReadArgs) -> int:
     """Read flash contents to file."""
-    with FlashIO(args.port, args.baudrate) as flash:
-        data = _read_with_progress(flash, args.address, args.size, "Reading")
+    with _open(args.link) as flash:
+        data = _read_with_progress(flash, args.address, args.size, "Reading", args.jtag)
 
     with open(args.output, "wb") as f:
         _ = f.write(data)
@@ -185,46 +319,212 @@ def _cmd_read(args: _ReadArgs) -> int:
 
 def _cmd_erase(args: _EraseArgs) -> int:
     """Erase flash blocks."""
-    with FlashIO(args.port, args.baudrate) as flash:
-        blocks = _erase_with_progress(flash, args.address, args.size, "Erasing")
+    with _open(args.link) as flash:
+        erased, skipped = _erase_with_progress(flash, args.address, args.size, "Erasing")
 
-    print(f"Erased {blocks} block(s)")
+    _print_erased(erased, skipped)
     return 0
 
 
-def _cmd_flash(args: _FlashArgs) -> int:
-    """Program flash from file."""
-    with open(args.input, "rb") as f:
+def _load_image(path: str, fmt: str, address: int) -> ihex.SegmentMap | None:
+    """Load a binary or Intel HEX image, None if it can't be parsed."""
+    with open(path, "rb") as f:
         raw_data = f.read()
 
     # Determine format and parse
-    use_ihex = args.format == "ihex" or (args.format == "auto" and ihex.detect(raw_data))
+    use_ihex = fmt == "ihex" or (fmt == "auto" and ihex.detect(raw_data))
+
+    if not use_ihex:
+        return ihex.SegmentMap([ihex.IHexSegment(address, raw_data)], ERASE_BLOCK_SIZE)
+
+    try:
+        segments = ihex.parse(raw_data)
+        image = ihex.segment_map(segments, address, ERASE_BLOCK_SIZE)
+    except ValueError as e:
+        print(f"Error parsing Intel HEX: {e}")
+        return None
+
+    sectors = image.sectors()
+    print(
+        f"Intel HEX: {len(segments)} record segment(s), {len(image.segments)} after "
+        f"coalescing, {image.size} bytes in {len(sectors)} sector(s)"
+    )
+    print(
+        "Sectors: "
+        + ", ".join(f"0x{r.address:04X}-0x{r.address + r.size - 1:04X}" for r in image.runs())
+    )
+    return image
+
+
+def _writer(flash: FlashIO, verify: bool) -> Callable[[int, bytes], Iterator[int]]:
+    """write_verify() when verifying inline, else write_stream()."""
+    return flash.write_verify if verify else flash.write_stream
+
+
+def _write_segments(
+    flash: FlashIO, image: ihex.SegmentMap, label: str, verify: bool = False
+) -> int:
+    """Write every segment of an image with one progress bar.
+
+    With verify each sector segment is read back in the same session.
+    """
+    progress = _ProgressBar(label, image.size, image.segments[0].address)
+    total_written = 0
+    write = _writer(flash, verify)
+
+    for segment in image.segments:
+        current_addr = segment.address
+        for written in write(segment.address, segment.data):
+            total_written += written
+            current_addr += written
+            progress.update(written, current_addr)
+
+    progress.finish()
+    return total_written
+
+
+def _cmd_flash(args: _FlashArgs) -> int:
+    """Program flash from file.
 
-    if use_ihex:
+    Only the sector runs holding image data are erased or compared, gaps
+    in a sparse Intel HEX image are never touched or sent over the link.
+    """
+    image = _load_image(args.input, args.format, args.address)
+    if image is None:
+        return 1
+
+    with _open(args.link) as flash:
+        # Read back while programming, a skipped sector was compared already
+        inline = args.verify and flash.has_write_verify
         try:
-            segments = ihex.parse(raw_data)
-            start_addr, data = ihex.merge_segments(segments, args.address)
-            print(
-                f"Intel HEX: {len(segments)} segment(s), {len(data)} bytes at 0x{start_addr:04X}"
-            )
-        except ValueError as e:
-            print(f"Error parsing Intel HEX: {e}")
+            _program_image(flash, image, args, inline)
+        except VerifyError as e:
+            print(f"\nVerification FAILED at 0x{e.address:04X}")
             return 1
+
+    if inline:
+        print("Verification PASSED")
+    elif args.verify:
+        return _verify_image(args.link, image)
+
+    return 0
+
+
+def _program_image(
+    flash: FlashIO, image: ihex.SegmentMap, args: _FlashArgs, verify: bool
+) -> None:
+    """Erase and program an image the way the flash options ask for."""
+    if args.no_erase:
+        _ = _write_segments(flash, image, "Writing", verify)
+    elif args.full:
+        erased = skipped = 0
+        for run in image.runs():
+            run_erased, run_skipped = _erase_with_progress(
+                flash, run.address, run.size, "Erasing"
+            )
+            erased += run_erased
+            skipped += run_skipped
+        _print_erased(erased, skipped)
+        _ = _write_segments(flash, image, "Writing", verify)
     else:
-        data = raw_data
-        start_addr = args.address
+        for run in image.runs():
+            _flash_differential(flash, *run.image(), verify)
+
+
+def _flash_differential(flash: FlashIO, address: int, data: bytes, verify: bool = False) -> None:
+    """Erase and program only the sectors that differ from the image."""
+    print("Comparing...")
+    update = plan.plan(flash, address, data)
+    print(f"Plan: {update.summary()}")
+
+    progress = _ProgressBar("Programming", update.program_size, address)
+    write = _writer(flash, verify)
+    for step in update.steps:
+        if step.action is plan.Action.SKIP:
+            continue
+        if step.action is plan.Action.REWRITE:
+            _ = flash.erase_blocks(step.address, 1)
+
+        current_addr = step.address
+        for written in write(step.address, step.data):
+            current_addr += written
+            progress.update(written, current_addr)
+    progress.finish()
+
+
+def _report_sites(label: str, results: list[SiteResult]) -> bool:
+    """Print per-site results, True if every site passed."""
+    line = ", ".join(f"{r.site}: {'ok' if r.okay else 'FAIL'}" for r in results)
+    print(f"{label}: {line}")
+    return all(r.okay for r in results)
+
+
+def _cmd_gang(args: _GangArgs) -> int:
+    """Program every gang site from file."""
+    image = _load_image(args.input, args.format, args.address)
+    if image is None:
+        return 1
+    start_addr, data = image.flatten()
+
+    with GangDevice(args.link.port, args.link.baudrate, args.link.bulk_baud) as gang:
+        okay = _report_sites("Link", gang.open())
 
-    with FlashIO(args.port, args.baudrate) as flash:
         if not args.no_erase:
-            blocks = _erase_with_progress(flash, start_addr, len(data), "Erasing")
-            print(f"Erased {blocks} block(s)")
+            okay &= _report_sites("Erase", gang.erase(start_addr, len(data)))
 
-        _ = _write_with_progress(flash, start_addr, data, "Writing")
+        progress = _ProgressBar("Writing", len(data), start_addr)
+        current_addr = start_addr
+        for written in gang.write(start_addr, data):
+            current_addr += written
+            progress.update(written, current_addr)
+        progress.finish()
 
-    if args.verify:
-        return _verify_data(args.port, args.baudrate, start_addr, data)
+        okay &= _report_sites("Verify", gang.verify(start_addr, data))
+
+    return 0 if okay else 1
 
-    return 0
+
+def _cmd_flash_many(args: _FlashManyArgs) -> int:
+    """Program the same image through every port in parallel."""
+    ports = station.expand_ports(args.ports)
+    if not ports:
+        print("No serial ports matched")
+        return 1
+
+    image = _load_image(args.input, args.format, args.address)
+    if image is None:
+        return 1
+    start_addr, data = image.flatten()
+
+    link = station.Link(
+        args.link.baudrate,
+        args.link.clock,
+        args.link.bulk_baud,
+        args.link.timing,
+        args.link.compress,
+    )
+    print(f"Programming {len(data)} bytes at 0x{start_addr:04X} on {len(ports)} port(s)")
+    progress = _StationProgress(ports, len(data))
+    results = station.program_all(
+        ports,
+        link,
+        start_addr,
+        data,
+        erase=not args.no_erase,
+        verify=not args.no_verify,
+        progress=progress.update,
+        workers=args.jobs,
+    )
+    progress.finish()
+
+    for result in results:
+        if result.okay:
+            print(f"{result.port}: PASS ({result.written} bytes in {result.elapsed:.2f}s)")
+        else:
+            print(f"{result.port}: FAIL: {result.error}")
+    failed = sum(1 for r in results if not r.okay)
+    print(f"{len(results) - failed} passed, {failed} failed")
+    return 1 if failed else 0
 
 
 def _cmd_verify(args: _VerifyArgs) -> int:
@@ -232,14 +532,200 @@ def _cmd_verify(args: _VerifyArgs) -> int:
     with open(args.input, "rb") as f:
         expected = f.read()
 
-    return _verify_data(args.port, args.baudrate, args.address, expected)
+    return _verify_data(args.link, args.address, expected)
+
+
+def _cmd_backup(args: _BackupArgs) -> int:
+    """Save main flash, every XPAGE bank and the custom block to one file."""
+    total = min(args.bank_size, FLASH_SIZE) * args.banks + args.custom_size
+    with _open(args.link) as flash:
+        if not flash.has_image:
+            print("Firmware does not support full-device images")
+            return 1
+        progress = _ProgressBar("Reading", total)
+        received = 0
+
+        def update(count: int) -> None:
+            nonlocal received
+            received += count
+            progress.update(count, received)
 
+        device = backup.read(flash, args.bank_size, args.banks, args.custom_size, update)
+        progress.finish()
 
-def _verify_data(port: str, baudrate: int, address: int, expected: bytes) -> int:
+    with open(args.output, "wb") as f:
+        _ = f.write(device.encode())
+
+    regions = ", ".join(f"{r.label} {len(r.data)} bytes" for r in device.regions)
+    print(f"Saved {regions} to {args.output}")
+    return 0
+
+
+def _cmd_restore(args: _RestoreArgs) -> int:
+    """Write an image saved by backup back to the device."""
+    with open(args.input, "rb") as f:
+        raw_data = f.read()
+    try:
+        device = backup.Image.decode(raw_data)
+    except ValueError as e:
+        print(f"Error reading image: {e}")
+        return 1
+
+    skipped = [r for r in device.regions if r.block == backup.BLOCK_CUSTOM]
+    if skipped:
+        print("Skipping the custom block, the firmware does not write option bytes")
+
+    with _open(args.link) as flash:
+        if not flash.has_image:
+            print("Firmware does not support full-device images")
+            return 1
+        progress = _ProgressBar("Restoring", device.size - sum(len(r.data) for r in skipped))
+        written = 0
+
+        def update(count: int) -> None:
+            nonlocal written
+            written += count
+            progress.update(count, written)
+
+        restored = backup.restore(flash, device, update)
+        progress.finish()
+
+        if not args.verify:
+            return 0
+
+        main = [r for r in device.regions if r.block == backup.BLOCK_MAIN]
+        bank_size = max((len(r.data) for r in main), default=0)
+        banks = len(main)
+        actual = backup.read(flash, bank_size, banks, 0)
+
+    expected = {(r.block, r.bank): r.data for r in restored}
+    for region in actual.regions:
+        if expected.get((region.block, region.bank), region.data) != region.data:
+            print(f"Verification FAILED in {region.label}")
+            wanted = expected[region.block, region.bank]
+            return _report_mismatch(region.address, wanted, region.data)
+    print("Verification PASSED")
+    return 0
+
+
+def _cmd_bench(args: _BenchArgs) -> int:
+    """Measure throughput and latency, writing CSV or JSON."""
+    link = args.link
+    device = FlashDevice(
+        link.port, link.baudrate, link.clock, link.bulk_baud, link.timing, link.compress
+    )
+    operations = args.operations or (
+        ["link_read", "link_write", "shift_read", "shift_write"]
+        if args.no_target
+        else ["read", "verify"] + (["link_read", "link_write"] if device.has_bench else [])
+    )
+
+    for name in operations:
+        operation = bench.OPERATIONS.get(name)
+        if operation is None:
+            print(f"Unknown operation '{name}', choose from {', '.join(bench.OPERATIONS)}")
+            return 1
+        if operation.target and args.no_target:
+            print(f"'{name}' needs a target, drop --no-target")
+            return 1
+        if operation.closed and not args.no_target:
+            print(f"'{name}' needs the target closed, add --no-target")
+            return 1
+        if operation.loopback and not device.has_bench:
+            print("Link operations need firmware built from the uno_bench environment")
+            return 1
+        if operation.destructive:
+            end = args.address + max(args.sizes)
+            print(f"Warning: '{name}' erases 0x{args.address:04X}-0x{end - 1:04X}", file=sys.stderr)
+
+    if not args.no_target:
+        device.open()
+    initial_baudrate = device.baudrate
+    try:
+        results: list[bench.Result] = []
+        for result in bench.sweep(
+            device, operations, args.sizes, args.bauds or [None], args.clocks or [None],
+            args.address, args.repeats,
+        ):
+            results.append(result)
+            print(
+                f"{result.operation} {result.size} B @ {result.baudrate} baud, clock {result.clock}: "
+                + f"p50 {result.p50 * 1000:.2f} ms, p99 {result.p99 * 1000:.2f} ms "
+                + f"({_ProgressBar._format_rate(result.rate)})",
+                file=sys.stderr,
+            )
+        if link.profile and device.has_stats:
+            print(device.stats().format(), file=sys.stderr)
+        if link.profile and (headroom := device.headroom()) is not None:
+            print(f"RAM headroom: {headroom} bytes", file=sys.stderr)
+    finally:
+        if device.baudrate != initial_baudrate:
+            _ = device.set_baudrate(initial_baudrate)
+        device.close()
+
+    write = bench.write_json if args.format == "json" else bench.write_csv
+    if args.output is None:
+        write(results, sys.stdout)
+    else:
+        with open(args.output, "w", newline="") as f:
+            write(results, f)
+    return 0
+
+
+def _verify_data(link: _LinkArgs, address: int, expected: bytes) -> int:
     """Compare flash contents against expected data."""
-    with FlashIO(port, baudrate) as flash:
+    with _open(link) as flash:
+        if flash.has_crc:
+            return _verify_crc(flash, address, expected)
         actual = _read_with_progress(flash, address, len(expected), "Verifying")
 
+    return _report_mismatch(address, expected, actual)
+
+
+def _verify_image(link: _LinkArgs, image: ihex.SegmentMap) -> int:
+    """Compare flash contents against every segment of an image."""
+    if len(image.segments) == 1:
+        segment = image.segments[0]
+        return _verify_data(link, segment.address, segment.data)
+
+    with _open(link) as flash:
+        for segment in image.segments:
+            if flash.has_crc and all(
+                ok for _, _, ok in flash.compare(segment.address, segment.data)
+            ):
+                continue
+            actual = b"".join(flash.read_stream(segment.address, len(segment.data)))
+            if actual != segment.data:
+                return _report_mismatch(segment.address, segment.data, actual)
+
+    print(f"Verification PASSED ({len(image.segments)} segments)")
+    return 0
+
+
+def _verify_crc(flash: FlashIO, address: int, expected: bytes) -> int:
+    """Verify by device-side CRC, reading back only the first bad segment."""
+    progress = _ProgressBar("Verifying", len(expected), address)
+    failed: list[tuple[int, int]] = []
+
+    for segment, length, matches in flash.compare(address, expected):
+        if not matches:
+            failed.append((segment, length))
+        progress.update(length, segment + length)
+    progress.finish()
+
+    if not failed:
+        print("Verification PASSED")
+        return 0
+
+    print(f"{len(failed)} sector(s) differ: " + ", ".join(f"0x{a:04X}" for a, _ in failed))
+    segment, length = failed[0]
+    offset = segment - address
+    actual = b"".join(flash.read_stream(segment, length))
+    return _report_mismatch(segment, expected[offset : offset + length], actual)
+
+
+def _report_mismatch(address: int, expected: bytes, actual: bytes) -> int:
+    """Print the first difference between expected and actual data."""
     if actual == expected:
         print("Verification PASSED")
         return 0
@@ -280,6 +766,34 @@ def main() -> int:
         default=115200,
         help="Baud rate (default: 115200)",
     )
+    _ = parser.add_argument(
+        "-c",
+        "--clock",
+        default=None,
+        help="TCK half-period in delay loops, or 'auto' to calibrate (default: firmware default)",
+    )
+    _ = parser.add_argument(
+        "--timing",
+        choices=sorted(TIMING_PROFILES),
+        default=None,
+        help="Waveform timing profile, falls back to conservative if the target fails readback (default: firmware default)",
+    )
+    _ = parser.add_argument(
+        "--compress",
+        action="store_true",
+        help="Run-length encode flash data on the wire, if the firmware supports it",
+    )
+    _ = parser.add_argument(
+        "--profile",
+        action="store_true",
+        help="Print firmware time per phase when done (uno_profile firmware)",
+    )
+    _ = parser.add_argument(
+        "--bulk-baud",
+        type=int,
+        default=BULK_BAUDRATE,
+        help=f"Baud rate for the binary bulk data path, 0 to disable (default: {BULK_BAUDRATE})",
+    )
 
     subparsers = parser.add_subparsers(dest="command", required=True)
 
@@ -305,6 +819,11 @@ def main() -> int:
         required=True,
         help="Number of bytes to read",
     )
+    _ = read_parser.add_argument(
+        "--jtag",
+        action="store_true",
+        help="Read over JTAG CODESCAN instead of ICP",
+    )
 
     # Erase command
     erase_parser = subparsers.add_parser("erase", help="Erase flash blocks")
@@ -345,6 +864,11 @@ def main() -> int:
         action="store_true",
         help="Skip erasing before write",
     )
+    _ = flash_parser.add_argument(
+        "--full",
+        action="store_true",
+        help="Erase and rewrite the whole range instead of only changed sectors",
+    )
     _ = flash_parser.add_argument(
         "-v",
         "--verify",
@@ -359,6 +883,79 @@ def main() -> int:
         help="Input file format (default: auto-detect)",
     )
 
+    # Gang command
+    gang_parser = subparsers.add_parser(
+        "gang", help="Program every site of a gang build (uno_gang firmware)"
+    )
+    _ = gang_parser.add_argument(
+        "input",
+        help="Input file (.bin or .hex)",
+    )
+    _ = gang_parser.add_argument(
+        "-a",
+        "--address",
+        type=_parse_int,
+        default=0,
+        help="Start address for binary files (default: 0)",
+    )
+    _ = gang_parser.add_argument(
+        "-f",
+        "--format",
+        choices=["auto", "ihex", "binary"],
+        default="auto",
+        help="Input file format (default: auto-detect)",
+    )
+    _ = gang_parser.add_argument(
+        "--no-erase",
+        action="store_true",
+        help="Skip erase before programming",
+    )
+
+    # Flash-many command
+    many_parser = subparsers.add_parser(
+        "flash-many", help="Program the same image through several programmers at once"
+    )
+    _ = many_parser.add_argument(
+        "input",
+        help="Input file (.bin or .hex)",
+    )
+    _ = many_parser.add_argument(
+        "ports",
+        nargs="+",
+        help="Serial ports or glob patterns, e.g. '/dev/ttyACM*' (--port is ignored)",
+    )
+    _ = many_parser.add_argument(
+        "-a",
+        "--address",
+        type=_parse_int,
+        default=0,
+        help="Start address for binary files (default: 0)",
+    )
+    _ = many_parser.add_argument(
+        "-f",
+        "--format",
+        choices=["auto", "ihex", "binary"],
+        default="auto",
+        help="Input file format (default: auto-detect)",
+    )
+    _ = many_parser.add_argument(
+        "--no-erase",
+        action="store_true",
+        help="Skip erase before programming",
+    )
+    _ = many_parser.add_argument(
+        "--no-verify",
+        action="store_true",
+        help="Skip verification after programming",
+    )
+    _ = many_parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=None,
+        help="Ports programmed at once (default: all)",
+    )
+
     # Verify command
     verify_parser = subparsers.add_parser("verify", help="Verify flash against file")
     _ = verify_parser.add_argument(
@@ -373,25 +970,136 @@ def main() -> int:
         help="Start address (default: 0)",
     )
 
+    # Backup command
+    backup_parser = subparsers.add_parser(
+        "backup", help="Save every flash bank and the custom block to one image file"
+    )
+    _ = backup_parser.add_argument(
+        "-o",
+        "--output",
+        required=True,
+        help="Output file path",
+    )
+    _ = backup_parser.add_argument(
+        "--bank-size",
+        type=_parse_int,
+        default=FLASH_SIZE,
+        help=f"Main flash bytes per XPAGE bank (default: 0x{FLASH_SIZE:X})",
+    )
+    _ = backup_parser.add_argument(
+        "--banks",
+        type=int,
+        default=1,
+        help="Number of XPAGE banks, 1 for parts up to 64K (default: 1)",
+    )
+    _ = backup_parser.add_argument(
+        "--custom-size",
+        type=_parse_int,
+        default=backup.DEFAULT_CUSTOM_SIZE,
+        help=f"Custom block bytes, 0 to leave it out (default: {backup.DEFAULT_CUSTOM_SIZE})",
+    )
+
+    # Restore command
+    restore_parser = subparsers.add_parser("restore", help="Write an image saved by backup")
+    _ = restore_parser.add_argument(
+        "input",
+        help="Image file path",
+    )
+    _ = restore_parser.add_argument(
+        "-v",
+        "--verify",
+        action="store_true",
+        help="Read the image back and compare after restoring",
+    )
+
+    # Bench command
+    bench_parser = subparsers.add_parser(
+        "bench", help="Measure throughput and per-call latency, output CSV or JSON"
+    )
+    _ = bench_parser.add_argument(
+        "--ops",
+        type=lambda v: [o for o in v.split(",") if o],
+        default=[],
+        help=f"Comma separated operations from {', '.join(bench.OPERATIONS)} "
+        + "(default: read,verify plus link ops when available)",
+    )
+    _ = bench_parser.add_argument(
+        "--sizes",
+        type=_parse_ints,
+        default=[256, 1024, 4096],
+        help="Comma separated transfer sizes in bytes (default: 256,1024,4096)",
+    )
+    _ = bench_parser.add_argument(
+        "--bauds",
+        type=_parse_ints,
+        default=[],
+        help="Comma separated bulk baud rates to sweep (default: --bulk-baud)",
+    )
+    _ = bench_parser.add_argument(
+        "--clocks",
+        type=_parse_ints,
+        default=[],
+        help="Comma separated TCK half-periods to sweep (default: --clock)",
+    )
+    _ = bench_parser.add_argument(
+        "-n",
+        "--repeats",
+        type=int,
+        default=5,
+        help="Calls per measurement (default: 5)",
+    )
+    _ = bench_parser.add_argument(
+        "-a",
+        "--address",
+        type=_parse_int,
+        default=0,
+        help="Flash address the target operations use (default: 0)",
+    )
+    _ = bench_parser.add_argument(
+        "--no-target",
+        action="store_true",
+        help="Leave the target closed and run only link operations",
+    )
+    _ = bench_parser.add_argument(
+        "--format",
+        choices=["csv", "json"],
+        default="csv",
+        help="Output format (default: csv)",
+    )
+    _ = bench_parser.add_argument(
+        "-o",
+        "--output",
+        default=None,
+        help="Output file (default: stdout)",
+    )
+
     ns = parser.parse_args()
     command = cast(str, ns.command)
+    link = _LinkArgs(
+        port=cast(str, ns.port),
+        baudrate=cast(int, ns.baudrate),
+        clock=cast(str | None, ns.clock),
+        bulk_baud=cast(int, ns.bulk_baud),
+        timing=cast(str | None, ns.timing),
+        profile=cast(bool, ns.profile),
+        compress=cast(bool, ns.compress),
+    )
 
     match command:
         case "read":
             return _cmd_read(
                 _ReadArgs(
-                    port=cast(str, ns.port),
-                    baudrate=cast(int, ns.baudrate),
+                    link=link,
                     output=cast(str, ns.output),
                     address=cast(int, ns.address),
                     size=cast(int, ns.size),
+                    jtag=cast(bool, ns.jtag),
                 )
             )
         case "erase":
             return _cmd_erase(
                 _EraseArgs(
-                    port=cast(str, ns.port),
-                    baudrate=cast(int, ns.baudrate),
+                    link=link,
                     address=cast(int, ns.address),
                     size=cast(int, ns.size),
                 )
@@ -399,24 +1107,79 @@ def main() -> int:
         case "flash" | "write":
             return _cmd_flash(
                 _FlashArgs(
-                    port=cast(str, ns.port),
-                    baudrate=cast(int, ns.baudrate),
+                    link=link,
                     input=cast(str, ns.input),
                     address=cast(int, ns.address),
                     no_erase=cast(bool, ns.no_erase),
+                    full=cast(bool, ns.full),
                     verify=cast(bool, ns.verify),
                     format=cast(str, ns.format),
                 )
             )
+        case "gang":
+            return _cmd_gang(
+                _GangArgs(
+                    link=link,
+                    input=cast(str, ns.input),
+                    address=cast(int, ns.address),
+                    no_erase=cast(bool, ns.no_erase),
+                    format=cast(str, ns.format),
+                )
+            )
+        case "flash-many":
+            return _cmd_flash_many(
+                _FlashManyArgs(
+                    link=link,
+                    input=cast(str, ns.input),
+                    ports=cast(list[str], ns.ports),
+                    address=cast(int, ns.address),
+                    no_erase=cast(bool, ns.no_erase),
+                    no_verify=cast(bool, ns.no_verify),
+                    jobs=cast(int | None, ns.jobs),
+                    format=cast(str, ns.format),
+                )
+            )
         case "verify":
             return _cmd_verify(
                 _VerifyArgs(
-                    port=cast(str, ns.port),
-                    baudrate=cast(int, ns.baudrate),
+                    link=link,
                     input=cast(str, ns.input),
                     address=cast(int, ns.address),
                 )
             )
+        case "backup":
+            return _cmd_backup(
+                _BackupArgs(
+                    link=link,
+                    output=cast(str, ns.output),
+                    bank_size=cast(int, ns.bank_size),
+                    banks=cast(int, ns.banks),
+                    custom_size=cast(int, ns.custom_size),
+                )
+            )
+        case "restore":
+            return _cmd_restore(
+                _RestoreArgs(
+                    link=link,
+                    input=cast(str, ns.input),
+                    verify=cast(bool, ns.verify),
+                )
+            )
+        case "bench":
+            return _cmd_bench(
+                _BenchArgs(
+                    link=link,
+                    operations=cast(list[str], ns.ops),
+                    sizes=cast(list[int], ns.sizes),
+                    bauds=cast(list[int], ns.bauds),
+                    clocks=cast(list[int], ns.clocks),
+                    repeats=cast(int, ns.repeats),
+                    address=cast(int, ns.address),
+                    no_target=cast(bool, ns.no_target),
+                    format=cast(str, ns.format),
+                    output=cast(str | None, ns.output),
+                )
+            )
         case _:
             parser.print_help()
             return 1
@@ -0,0 +1,170 @@
+"""Full-device backups: main flash, XPAGE banks and the custom block.
+
+The firmware reads every region in one ICP session (icp_read_image), the
+host keeps them in a tagged container so an image restores to the same
+blocks and banks it came from.
+
+Container layout, little endian:
+    "SJIM", u8 version, u8 region count
+    per region: u8 block, u8 bank, u16 address, u32 length, u32 CRC-32, data
+"""
+
+import struct
+import zlib
+from collections.abc import Callable
+from dataclasses import dataclass
+from typing import Self
+
+from .flash import ERASE_BLOCK_SIZE, FLASH_SIZE, FlashIO
+
+MAGIC = b"SJIM"
+VERSION = 1
+BLOCK_MAIN = 0  # Must match sinowealth::ICP::Block
+BLOCK_CUSTOM = 1
+DEFAULT_CUSTOM_SIZE = 256  # Custom block bytes read when not told otherwise
+
+_HEADER = struct.Struct("<4sBB")
+_REGION = struct.Struct("<BBHII")
+
+
+@dataclass(frozen=True)
+class Region:
+    """One contiguous range of a block and bank."""
+
+    block: int
+    bank: int
+    address: int
+    data: bytes
+
+    @property
+    def label(self) -> str:
+        """Human readable name of the region."""
+        if self.block == BLOCK_CUSTOM:
+            return "custom"
+        return f"bank {self.bank}"
+
+
+@dataclass(frozen=True)
+class Image:
+    """Regions of a device in the order they were read."""
+
+    regions: list[Region]
+
+    @property
+    def size(self) -> int:
+        """Data bytes over all regions."""
+        return sum(len(r.data) for r in self.regions)
+
+    def encode(self) -> bytes:
+        """The image as a container file."""
+        out = bytearray(_HEADER.pack(MAGIC, VERSION, len(self.regions)))
+        for r in self.regions:
+            out += _REGION.pack(r.block, r.bank, r.address, len(r.data), zlib.crc32(r.data))
+            out += r.data
+        return bytes(out)
+
+    @classmethod
+    def decode(cls, data: bytes) -> Self:
+        """Parse a container file.
+
+        Raises:
+            ValueError: If the file is not a container or a region is corrupt.
+        """
+        if len(data) < _HEADER.size:
+            raise ValueError("File too short for an image container")
+        magic, version, count = _HEADER.unpack_from(data)
+        if magic != MAGIC:
+            raise ValueError("Not an image container")
+        if version != VERSION:
+            raise ValueError(f"Unsupported image version {version}")
+
+        regions: list[Region] = []
+        offset = _HEADER.size
+        for _ in range(count):
+            if offset + _REGION.size > len(data):
+                raise ValueError("Truncated region header")
+            block, bank, address, length, crc = _REGION.unpack_from(data, offset)
+            offset += _REGION.size
+            payload = data[offset : offset + length]
+            if len(payload) != length:
+                raise ValueError(f"Truncated region at bank {bank}, block {block}")
+            if zlib.crc32(payload) != crc:
+                raise ValueError(f"CRC mismatch in region at bank {bank}, block {block}")
+            regions.append(Region(block, bank, address, payload))
+            offset += length
+        return cls(regions)
+
+
+def read(
+    flash: FlashIO,
+    bank_size: int = FLASH_SIZE,
+    banks: int = 1,
+    custom_size: int = DEFAULT_CUSTOM_SIZE,
+    progress: Callable[[int], None] | None = None,
+) -> Image:
+    """Read every bank and the custom block in one call.
+
+    Args:
+        flash: Open device.
+        bank_size: Bytes of main flash per XPAGE bank, at most 64K.
+        banks: Number of banks, 1 for parts up to 64K.
+        custom_size: Custom block bytes, 0 to leave it out.
+        progress: Called with the byte count of each received frame.
+
+    Raises:
+        OSError: If the firmware lacks icp_read_image or the read fails.
+    """
+    if not flash.has_image:
+        raise OSError("Firmware does not support full-device images")
+    bank_size = min(bank_size, FLASH_SIZE)
+
+    data = bytearray()
+    for chunk in flash.read_image(bank_size, banks, custom_size):
+        data += chunk
+        if progress:
+            progress(len(chunk))
+
+    regions = [
+        Region(BLOCK_MAIN, bank, 0, bytes(data[bank * bank_size : (bank + 1) * bank_size]))
+        for bank in range(banks)
+    ]
+    if custom_size:
+        regions.append(Region(BLOCK_CUSTOM, 0, 0, bytes(data[banks * bank_size :])))
+    return Image(regions)
+
+
+def restore(
+    flash: FlashIO,
+    image: Image,
+    progress: Callable[[int], None] | None = None,
+) -> list[Region]:
+    """Erase and program every main flash region of an image.
+
+    The custom block holds the option bytes. The firmware refuses to erase
+    or write it until the command that selects it is confirmed, since a bad
+    copy can lock a part, so it is skipped.
+
+    Args:
+        flash: Open device.
+        image: Image to restore.
+        progress: Called with byte counts as the device consumes them.
+
+    Returns:
+        The regions that were written.
+    """
+    if not flash.has_image:
+        raise OSError("Firmware does not support full-device images")
+
+    written: list[Region] = []
+    for region in image.regions:
+        if region.block == BLOCK_CUSTOM:
+            continue
+        end = region.address + len(region.data)
+        start = (region.address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+        for sector in range(start, end, ERASE_BLOCK_SIZE):
+            _ = flash.erase_region(region.block, region.bank, sector)
+        for count in flash.write_region(region.block, region.bank, region.address, region.data):
+            if progress:
+                progress(count)
+        written.append(region)
+    return written
@@ -0,0 +1,161 @@
+"""Throughput benchmark for the flash and link paths.
+
+Times whole operations on a FlashDevice across transfer sizes, bulk baud
+rates and TCK settings, and reports per-call latency percentiles.
+
+The link_* operations move bulk frames without touching the target and
+the shift_* ones also clock every byte through the ICP shifter with the
+pins Hi-Z, separating link cost from target cost. Both need firmware
+built from the uno_bench environment, shift_* also needs the target
+left closed.
+"""
+
+import csv
+import json
+import math
+import time
+from collections.abc import Callable, Iterable, Iterator
+from dataclasses import asdict, dataclass, fields
+from typing import TextIO
+
+from .flash import ERASE_BLOCK_SIZE, FlashDevice
+
+
+@dataclass(frozen=True)
+class Operation:
+    """A benchmarked operation on size bytes at an address."""
+
+    run: Callable[[FlashDevice, int, bytes], object]
+    prepare: Callable[[FlashDevice, int, bytes], object] | None = None  # Untimed
+    target: bool = True  # Needs the target opened
+    closed: bool = False  # Needs the target left closed
+    loopback: bool = False  # Needs uno_bench firmware
+    destructive: bool = False  # Erases or overwrites flash
+
+
+def _blocks(address: int, size: int) -> int:
+    """Number of erase blocks covering a range."""
+    start = address // ERASE_BLOCK_SIZE
+    return (address + size + ERASE_BLOCK_SIZE - 1) // ERASE_BLOCK_SIZE - start
+
+
+def _read(device: FlashDevice, address: int, data: bytes) -> object:
+    return b"".join(device.read_stream(address, len(data)))
+
+
+def _write(device: FlashDevice, address: int, data: bytes) -> object:
+    return sum(device.write_stream(address, data))
+
+
+def _erase(device: FlashDevice, address: int, data: bytes) -> object:
+    return device.erase_blocks(address, _blocks(address, len(data)))
+
+
+OPERATIONS: dict[str, Operation] = {
+    "read": Operation(_read),
+    "verify": Operation(lambda d, a, data: d.crc(a, len(data))),
+    "erase": Operation(_erase, destructive=True),
+    "write": Operation(_write, prepare=_erase, destructive=True),
+    "link_read": Operation(
+        lambda d, a, data: d.bench_read(len(data)), target=False, loopback=True
+    ),
+    "link_write": Operation(
+        lambda d, a, data: d.bench_write(data), target=False, loopback=True
+    ),
+    "shift_read": Operation(
+        lambda d, a, data: d.bench_read(len(data), True), target=False, closed=True, loopback=True
+    ),
+    "shift_write": Operation(
+        lambda d, a, data: d.bench_write(data, True), target=False, closed=True, loopback=True
+    ),
+}
+
+
+@dataclass(frozen=True)
+class Result:
+    """Latency and throughput of one operation at one setting."""
+
+    operation: str
+    size: int
+    baudrate: int
+    clock: int  # TCK half-period in delay loops
+    repeats: int
+    p50: float  # Seconds per call
+    p99: float
+    rate: float  # Bytes per second at p50
+
+
+def percentile(samples: list[float], fraction: float) -> float:
+    """Nearest-rank percentile of a non-empty sample list."""
+    ordered = sorted(samples)
+    rank = max(1, math.ceil(fraction * len(ordered)))
+    return ordered[rank - 1]
+
+
+def measure(
+    device: FlashDevice, name: str, address: int, size: int, repeats: int
+) -> list[float]:
+    """Run an operation repeats times and return each call's duration."""
+    operation = OPERATIONS[name]
+    data = bytes(n & 0xFF for n in range(size))
+    samples: list[float] = []
+    for _ in range(repeats):
+        if operation.prepare is not None:
+            _ = operation.prepare(device, address, data)
+        start = time.perf_counter()
+        _ = operation.run(device, address, data)
+        samples.append(time.perf_counter() - start)
+    return samples
+
+
+def sweep(
+    device: FlashDevice,
+    operations: Iterable[str],
+    sizes: Iterable[int],
+    baudrates: Iterable[int | None],
+    clocks: Iterable[int | None],
+    address: int = 0,
+    repeats: int = 5,
+) -> Iterator[Result]:
+    """Measure every combination, None keeps the current setting.
+
+    Raises:
+        OSError: If the firmware rejects a baud rate.
+    """
+    operations = list(operations)
+    sizes = list(sizes)
+    clocks = list(clocks)
+    for baudrate in baudrates:
+        if baudrate is not None and not device.set_baudrate(baudrate):
+            raise OSError(f"Firmware rejected {baudrate} baud")
+        for clock in clocks:
+            if clock is not None:
+                device.set_clock(clock)
+            for name in operations:
+                for size in sizes:
+                    samples = measure(device, name, address, size, repeats)
+                    p50 = percentile(samples, 0.50)
+                    yield Result(
+                        operation=name,
+                        size=size,
+                        baudrate=device.baudrate,
+                        clock=device.get_clock(),
+                        repeats=repeats,
+                        p50=p50,
+                        p99=percentile(samples, 0.99),
+                        rate=size / p50 if p50 > 0 else 0.0,
+                    )
+
+
+def write_csv(results: Iterable[Result], stream: TextIO) -> None:
+    """Write results as CSV with a header row."""
+    writer = csv.writer(stream)
+    _ = writer.writerow(f.name for f in fields(Result))
+    for result in results:
+        _ = writer.writerow(asdict(result).values())
+
+
+def write_json(results: Iterable[Result], stream: TextIO) -> None:
+    """Write results as a JSON array of objects."""
+    json.dump([asdict(r) for r in results], stream, indent=2)
+    _ = stream.write("\n")
@@ -4,16 +4,42 @@ Provides low-level and file-like interfaces for SinoWealth MCU flash
 memory access via Arduino-based JTAG programmer.
 """
 
-from collections.abc import Buffer
+import zlib
+from collections.abc import Buffer, Iterator
 from io import RawIOBase
 from types import TracebackType
 from typing import Self, override
 
 from simple_rpc import Interface
 
+from . import frame, rle
+from .pipeline import Pipeline
+from .stats import Stats
+
 # Hardware constraints
-MAX_TRANSFER_SIZE = 64  # Arduino RAM limit
+MAX_TRANSFER_SIZE = 64  # icp_write Vector size, heap allocated by simpleRPC
 ERASE_BLOCK_SIZE = 1024  # Target flash erase block size
+FLASH_SIZE = 0x10000  # 16-bit ICP address space
+STREAM_CHUNK_SIZE = 256  # Host-side read granularity for streamed data
+BULK_READ_SIZE = 4096  # Bulk read frame size
+STREAM_WRITE_SIZE = 0x8000  # Streamed write frame size
+DEFAULT_BAUDRATE = 115200  # Firmware UART rate after reset
+BULK_BAUDRATE = 1000000  # Preferred rate for the bulk data path
+CLOCK_AUTO = "auto"  # Calibrate TCK rate on open
+CLOCK_FAILED = 0xFF  # icp_calibrate result when no rate passed
+ERASE_FAILED = 0xFFFF  # icp_erase_range duration of a failed sector
+TIMING_PROFILES = {"conservative": 0, "fast": 1}  # phy_set_timing profile IDs
+VERIFY_OK = 0xFFFF  # icp_write_verify mismatch offset when the readback matched
+
+
+class VerifyError(OSError):
+    """Flash read back differently right after programming."""
+
+    address: int
+
+    def __init__(self, address: int):
+        super().__init__(f"Verification failed at 0x{address:04X}")
+        self.address = address
 
 
 class FlashDevice:
@@ -21,42 +47,559 @@ class FlashDevice:
 
     _rpc: Interface
     _initialized: bool
+    _clock: str | None
+    _timing: str | None
+    _bulk_baudrate: int
+    _bulk: bool
+    _capacity: int
+    _compress: bool
 
-    def __init__(self, port: str = "/dev/ttyACM0", baudrate: int = 115200):
+    def __init__(
+        self,
+        port: str = "/dev/ttyACM0",
+        baudrate: int = DEFAULT_BAUDRATE,
+        clock: str | None = None,
+        bulk_baudrate: int = BULK_BAUDRATE,
+        timing: str | None = None,
+        compress: bool = False,
+    ):
         self._rpc = Interface(port, baudrate)
         self._initialized = False
+        self._clock = clock
+        self._timing = timing
+        self._bulk_baudrate = bulk_baudrate
+        self._bulk = False
+        self._capacity = MAX_TRANSFER_SIZE
+        self._compress = compress
+
+    @property
+    def bulk(self) -> bool:
+        """True if the binary bulk data path is in use."""
+        return self._bulk
+
+    @property
+    def compressed(self) -> bool:
+        """True if transfers are run-length encoded on the wire."""
+        return self._compress and hasattr(self._rpc, "icp_read_rle")
 
     def open(self) -> None:
         """Initialize the JTAG interface."""
         if not self._initialized:
-            self._rpc.phy_init()
+            # Selected before phy_init so the entry waveform uses it too
+            if self._timing is not None:
+                _ = self.set_timing(self._timing)
+            self._attach()
+            if self._clock == CLOCK_AUTO:
+                _ = self.calibrate_clock()
+            elif self._clock is not None:
+                self.set_clock(int(self._clock, 0))
+            if self._timing is not None:
+                _ = self.set_timing(self._timing)
+            _ = self._rpc.session_open()
+            self._capacity = self._query_capacity()
+            if self._bulk_baudrate:
+                self._bulk = self.set_baudrate(self._bulk_baudrate)
             self._initialized = True
 
     def close(self) -> None:
         """Release the JTAG interface."""
         if self._initialized:
-            _ = self._rpc.phy_reset()
+            self._rpc.session_close()
+            if self._bulk:
+                _ = self.set_baudrate(DEFAULT_BAUDRATE)
+                self._bulk = False
             self._initialized = False
 
+    def _attach(self) -> bool:
+        """Reuse a target still in diagnostic mode, else run the entry waveform.
+
+        Returns:
+            True if the entry waveform was skipped
+        """
+        try:
+            return self._rpc.phy_attach()
+        except AttributeError:
+            self._rpc.phy_init()
+            return False
+
+    def _query_capacity(self) -> int:
+        """Size of the firmware transfer buffer, MAX_TRANSFER_SIZE if unknown."""
+        try:
+            return self._rpc.buffer_capacity()
+        except AttributeError:
+            return MAX_TRANSFER_SIZE
+
+    @property
+    def capacity(self) -> int:
+        """Size of the firmware transfer buffer."""
+        return self._capacity
+
+    def set_timing(self, profile: str) -> bool:
+        """Select a waveform timing profile by name.
+
+        Once the PHY is initialized the firmware verifies the profile via
+        ICP readback and falls back to conservative timing if it fails.
+
+        Returns:
+            True if the profile is active
+        """
+        return self._rpc.phy_set_timing(TIMING_PROFILES[profile])
+
+    @property
+    def timing(self) -> str:
+        """Name of the active waveform timing profile."""
+        active = self._rpc.phy_get_timing()
+        return next(name for name, value in TIMING_PROFILES.items() if value == active)
+
+    def set_baudrate(self, baudrate: int) -> bool:
+        """Switch the link to a new baud rate.
+
+        Returns:
+            False if the firmware lacks bulk support or rejected the rate.
+        """
+        try:
+            okay = self._rpc.link_set_baud(baudrate)
+        except AttributeError:
+            return False
+        if okay:
+            serial = self._rpc._connection
+            serial.flush()
+            serial.baudrate = baudrate
+        return okay
+
+    @property
+    def baudrate(self) -> int:
+        """Current UART baud rate of the link."""
+        return self._rpc._connection.baudrate
+
     def __del__(self) -> None:
         self._rpc.phy_stop()
 
+    def set_clock(self, loops: int) -> None:
+        """Set the TCK half-period in 3-cycle delay loops (0 = fastest)."""
+        self._rpc.phy_set_clock(loops)
+
+    def get_clock(self) -> int:
+        """Return the TCK half-period in 3-cycle delay loops."""
+        return self._rpc.phy_get_clock()
+
+    def calibrate_clock(self) -> int:
+        """Select the fastest TCK rate that passes ICP readback.
+
+        Raises:
+            OSError: If no rate passed; the previous rate is kept.
+        """
+        loops = self._rpc.icp_calibrate()
+        if loops == CLOCK_FAILED:
+            raise OSError("TCK calibration failed: no rate passed ICP readback")
+        return loops
+
     def read_chunk(self, address: int, size: int) -> bytes:
-        """Read up to MAX_TRANSFER_SIZE bytes from flash."""
-        size = min(size, MAX_TRANSFER_SIZE)
+        """Read up to capacity bytes from flash."""
+        size = min(size, self._capacity)
+        if self.compressed:
+            return b"".join(self._rle_read(address, size))
         data = self._rpc.icp_read(address, size)
         return bytes(data)
 
+    def read_stream(
+        self, address: int, size: int, chunk_size: int = STREAM_CHUNK_SIZE
+    ) -> Iterator[bytes]:
+        """Read a flash range in one ICP session, yielding chunks as they arrive.
+
+        The firmware clamps the range to the end of flash, so does this.
+        The generator must be exhausted before issuing another command.
+        """
+        size = max(0, min(size, FLASH_SIZE - address))
+        if self.compressed:
+            yield from self._rle_read(address, size)
+            return
+        if self._bulk:
+            yield from self._bulk_read(address, size)
+            return
+
+        self._rpc.icp_read_stream(address, size)
+
+        serial = self._rpc._connection
+        remaining = size
+        while remaining > 0:
+            chunk = serial.read(min(remaining, chunk_size))
+            if not chunk:
+                raise OSError(
+                    f"Stream read timed out at 0x{address + size - remaining:04X}"
+                )
+            remaining -= len(chunk)
+            yield bytes(chunk)
+
+    def _bulk_read(self, address: int, size: int) -> Iterator[bytes]:
+        """Read a range as checksummed bulk frames."""
+        serial = self._rpc._connection
+        end = address + size
+        while address < end:
+            length = min(end - address, BULK_READ_SIZE)
+            self._rpc.icp_bulk_read(address, length)
+            payload = frame.receive(serial)
+            if len(payload) != length:
+                raise OSError(f"Bulk read failed at 0x{address:04X}")
+            address += length
+            yield payload
+
+    def _rle_read(self, address: int, size: int) -> Iterator[bytes]:
+        """Read a range as run-length encoded frames, ended by an empty one."""
+        serial = self._rpc._connection
+        self._rpc.icp_read_rle(address, size)
+        received = 0
+        while payload := frame.receive(serial):
+            data = rle.decode(payload)
+            received += len(data)
+            yield data
+        if received != size:
+            raise OSError(f"Compressed read failed at 0x{address + received:04X}")
+
+    def codescan_read(self, address: int, size: int) -> Iterator[bytes]:
+        """Read a range over JTAG CODESCAN as bulk frames.
+
+        Slower than ICP but works on parts where ICP is unavailable.
+        """
+        size = max(0, min(size, FLASH_SIZE - address))
+        serial = self._rpc._connection
+        end = address + size
+        while address < end:
+            length = min(end - address, BULK_READ_SIZE)
+            self._rpc.tap_codescan_read_block(address, length)
+            payload = frame.receive(serial)
+            if len(payload) != length:
+                raise OSError(f"CODESCAN read failed at 0x{address:04X}")
+            address += length
+            yield payload
+
+    @property
+    def max_write(self) -> int:
+        """Largest chunk write_chunk() accepts."""
+        return self._capacity if self._bulk else MAX_TRANSFER_SIZE
+
     def write_chunk(self, address: int, data: bytes) -> int:
-        """Write up to MAX_TRANSFER_SIZE bytes to flash. Returns bytes written."""
-        data = data[:MAX_TRANSFER_SIZE]
-        return self._rpc.icp_write(address, list(data))
+        """Write up to max_write bytes to flash. Returns bytes written."""
+        data = data[: self.max_write]
+        if self._bulk:
+            self._rpc.icp_bulk_write(address)
+            status = frame.send(self._rpc._connection, data)
+            return len(data) if status == frame.Status.OK else 0
+        return len(data) if self._rpc.icp_write(address, list(data)) else 0
+
+    def read_sector(self, address: int) -> bytes:
+        """Read the 1KB sector containing address in one round trip."""
+        self._require_bulk()
+        self._rpc.icp_read_sector(address)
+        data = frame.receive(self._rpc._connection)
+        if len(data) != ERASE_BLOCK_SIZE:
+            raise OSError(f"Sector read failed at 0x{address:04X}")
+        return data
+
+    def write_sector(self, address: int, data: Buffer) -> None:
+        """Write a whole erased 1KB sector in one round trip."""
+        self._require_bulk()
+        view = memoryview(data).cast("B")
+        if len(view) != ERASE_BLOCK_SIZE:
+            raise ValueError(f"Sector data must be {ERASE_BLOCK_SIZE} bytes")
+        self._rpc.icp_write_sector(address)
+        frame.checked(frame.send(self._rpc._connection, view))
+
+    def _require_bulk(self) -> None:
+        """Raise unless the bulk data path and a sector buffer are available."""
+        if not self._bulk or self._capacity < ERASE_BLOCK_SIZE:
+            raise OSError("Sector transfers need the bulk data path")
+
+    def write_stream(self, address: int, data: Buffer) -> Iterator[int]:
+        """Write a range, yielding byte counts as the device consumes them.
+
+        On the bulk path the UART keeps receiving while the device
+        programs; otherwise this falls back to write_chunk().
+
+        Raises:
+            OSError: If the device reports a failure.
+        """
+        view = memoryview(data).cast("B")
+        if self.compressed:
+            yield from self._rle_write(address, view)
+            return
+
+        offset = 0
+        while offset < len(view):
+            if self._bulk:
+                chunk = view[offset : offset + STREAM_WRITE_SIZE]
+                self._rpc.icp_write_stream(address + offset)
+                for count in frame.send_stream(self._rpc._connection, chunk):
+                    yield count
+                offset += len(chunk)
+            else:
+                chunk = bytes(view[offset : offset + MAX_TRANSFER_SIZE])
+                written = self.write_chunk(address + offset, chunk)
+                if written <= 0:
+                    raise OSError(f"Write failed at 0x{address + offset:04X}")
+                offset += written
+                yield written
+
+    @property
+    def has_write_verify(self) -> bool:
+        """True if the firmware can program and read back in one call."""
+        return hasattr(self._rpc, "icp_write_verify")
+
+    def write_verify(self, address: int, data: Buffer) -> Iterator[int]:
+        """Program a range and read back each sector segment in the same session.
+
+        Raises:
+            VerifyError: At the first byte that read back differently.
+            OSError: If the device rejects a frame.
+        """
+        view = memoryview(data).cast("B")
+        offset = 0
+        while offset < len(view):
+            current = address + offset
+            sector_end = (current // ERASE_BLOCK_SIZE + 1) * ERASE_BLOCK_SIZE
+            length = min(len(view) - offset, sector_end - current, self._capacity)
+            self._rpc.icp_write_verify(current)
+            reply = frame.exchange(self._rpc._connection, view[offset : offset + length])
+            status, mismatch = frame.Status(reply[0]), int.from_bytes(reply[1:3], "little")
+            if mismatch != VERIFY_OK:
+                raise VerifyError(current + mismatch)
+            frame.checked(status)
+            offset += length
+            yield length
+
+    def _rle_write(self, address: int, view: memoryview) -> Iterator[int]:
+        """Write a range as run-length encoded frames of up to capacity bytes."""
+        for offset, length, payload in rle.frames(view, self._capacity):
+            self._rpc.icp_write_rle(address + offset)
+            frame.checked(frame.send(self._rpc._connection, payload))
+            yield length
+
+    @property
+    def has_crc(self) -> bool:
+        """True if the firmware can checksum flash on the device."""
+        return hasattr(self._rpc, "icp_crc")
+
+    def crc(self, address: int, size: int) -> int:
+        """CRC-32 (zlib) of a flash range, computed on the device."""
+        return self._rpc.icp_crc(address, size)
+
+    def crc_sectors(self, address: int, count: int) -> list[int]:
+        """CRC-32 (zlib) of each 1KB sector starting at the one containing address."""
+        return list(self._rpc.icp_crc_sectors(address, count))
+
+    def compare(self, address: int, data: Buffer) -> Iterator[tuple[int, int, bool]]:
+        """Compare flash against data by device-side CRC, without reading it back.
+
+        The range is split at sector boundaries. Whole sectors are checked in
+        batches with crc_sectors() and partial ones with crc().
+
+        Yields:
+            (address, length, matches) for each sector-bounded segment.
+
+        Raises:
+            OSError: If the device returned fewer sector CRCs than asked for.
+        """
+        view = memoryview(data).cast("B")
+        end = address + len(view)
+        batch = max(1, min(self._capacity // 4, 0xFF))  # icp_crc_sectors count is a u8
+
+        current = address
+        while current < end:
+            sector_end = (current // ERASE_BLOCK_SIZE + 1) * ERASE_BLOCK_SIZE
+            if current % ERASE_BLOCK_SIZE or sector_end > end:
+                length = min(sector_end, end) - current
+                offset = current - address
+                expected = zlib.crc32(view[offset : offset + length])
+                yield current, length, self.crc(current, length) == expected
+                current += length
+                continue
+
+            count = min((end - current) // ERASE_BLOCK_SIZE, batch)
+            crcs = self.crc_sectors(current, count)
+            if len(crcs) != count:
+                raise OSError(f"Got {len(crcs)} of {count} sector CRCs at 0x{current:04X}")
+            for index, actual in enumerate(crcs):
+                offset = current - address + index * ERASE_BLOCK_SIZE
+                expected = zlib.crc32(view[offset : offset + ERASE_BLOCK_SIZE])
+                yield current + index * ERASE_BLOCK_SIZE, ERASE_BLOCK_SIZE, actual == expected
+            current += count * ERASE_BLOCK_SIZE
+
+    @property
+    def has_blank_check(self) -> bool:
+        """True if the firmware can blank check flash on the device."""
+        return hasattr(self._rpc, "icp_blank_check")
+
+    def is_blank(self, address: int, size: int) -> bool:
+        """True if the range reads all 0xFF. Always False without firmware support."""
+        if not self.has_blank_check:
+            return False
+        return self._rpc.icp_blank_check(address, size)
+
+    def scan(self, program: bytes) -> bytes:
+        """Run an encoded scan program (see sinojtag.scan) in one call."""
+        return bytes(self._rpc.tap_batch(list(program)))
+
+    @property
+    def has_pipeline(self) -> bool:
+        """True if the firmware runs tagged request pipelines."""
+        return hasattr(self._rpc, "pipeline_run")
+
+    def pipeline(self) -> Pipeline:
+        """Open a request pipeline, see sinojtag.pipeline.
+
+        Raises:
+            OSError: If the firmware has no pipeline support.
+        """
+        if not self.has_pipeline:
+            raise OSError("Firmware has no pipeline_run")
+        pipe = Pipeline(self._rpc)
+        pipe.open()
+        return pipe
+
+    @property
+    def has_stats(self) -> bool:
+        """True if the firmware was built with profile counters."""
+        return hasattr(self._rpc, "stats_get")
+
+    def stats(self) -> Stats:
+        """Profile counters since the firmware started or reset_stats().
+
+        Raises:
+            OSError: If the firmware was built without SINOJTAG_PROFILE.
+        """
+        if not self.has_stats:
+            raise OSError("Firmware was built without SINOJTAG_PROFILE")
+        return Stats.decode(self._rpc.stats_get())
+
+    def reset_stats(self) -> None:
+        """Zero the profile counters, if the firmware has them."""
+        if self.has_stats:
+            self._rpc.stats_reset()
+
+    def headroom(self) -> int | None:
+        """Smallest free RAM between heap and stack since boot, None if unknown."""
+        try:
+            return self._rpc.link_headroom()
+        except AttributeError:
+            return None
+
+    @property
+    def has_bench(self) -> bool:
+        """True if the firmware has the benchmark loopback RPCs."""
+        return hasattr(self._rpc, "bench_read")
+
+    def bench_read(self, size: int, shift: bool = False) -> bytes:
+        """Receive a synthetic bulk frame without touching a target.
+
+        Args:
+            size: Payload bytes.
+            shift: Clock every byte through the ICP shifter as well.
+
+        Raises:
+            OSError: If the frame came back short, shift needs the PHY closed.
+        """
+        self._rpc.bench_read(size, shift)
+        data = frame.receive(self._rpc._connection)
+        if len(data) != size:
+            raise OSError("Bench read failed, shifting needs the PHY closed")
+        return data
+
+    def bench_write(self, data: Buffer, shift: bool = False) -> None:
+        """Send a bulk frame the device discards, see bench_read().
+
+        Raises:
+            OSError: If the device rejects the frame.
+        """
+        self._rpc.bench_write(shift)
+        frame.checked(frame.send(self._rpc._connection, memoryview(data).cast("B")))
+
+    @property
+    def has_image(self) -> bool:
+        """True if the firmware can reach XPAGE banks and the custom block."""
+        return hasattr(self._rpc, "icp_read_image")
+
+    def read_image(self, bank_size: int, banks: int, custom_size: int) -> Iterator[bytes]:
+        """Stream main flash bank by bank then the custom block in one call.
+
+        The generator must be exhausted before issuing another command.
+
+        Raises:
+            OSError: If the device sent less than requested.
+        """
+        expected = min(bank_size, FLASH_SIZE) * banks + custom_size
+        self._rpc.icp_read_image(bank_size, banks, custom_size)
+        received = 0
+        while payload := frame.receive(self._rpc._connection):
+            received += len(payload)
+            yield payload
+        if received != expected:
+            raise OSError(f"Image read failed after {received} of {expected} bytes")
+
+    def erase_region(self, block: int, bank: int, address: int) -> int:
+        """Erase the 1KB sector of a block and bank containing address.
+
+        Returns:
+            Erase time in ms
+
+        Raises:
+            OSError: If the sector failed to erase.
+        """
+        block_address = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+        duration = self._rpc.icp_erase_region(block, bank, block_address)
+        if duration == ERASE_FAILED:
+            raise OSError(f"Erase failed at {bank}:0x{block_address:04X} (block {block})")
+        return duration
+
+    def write_region(self, block: int, bank: int, address: int, data: Buffer) -> Iterator[int]:
+        """Program erased space of a block and bank, yielding byte counts.
+
+        Raises:
+            OSError: If the device reports a failure.
+        """
+        view = memoryview(data).cast("B")
+        for offset in range(0, len(view), STREAM_WRITE_SIZE):
+            chunk = view[offset : offset + STREAM_WRITE_SIZE]
+            self._rpc.icp_write_region(block, bank, address + offset)
+            yield from frame.send_stream(self._rpc._connection, chunk)
 
     def erase_block(self, address: int) -> bool:
         """Erase the 1KB block containing the given address."""
         block_address = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
         return self._rpc.icp_erase(block_address)
 
+    def erase_blocks(self, address: int, count: int) -> list[int]:
+        """Erase consecutive 1KB blocks starting at the one containing address.
+
+        Uses icp_erase_range when the firmware has it, so the whole run is one
+        session and the erase time is measured on the device.
+
+        Returns:
+            Erase time in ms per block, 0 when the firmware can't measure it.
+
+        Raises:
+            OSError: If a block fails to erase.
+        """
+        block_address = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+        if not hasattr(self._rpc, "icp_erase_range"):
+            durations: list[int] = []
+            for n in range(count):
+                if not self.erase_block(block_address + n * ERASE_BLOCK_SIZE):
+                    raise OSError(f"Erase failed at 0x{block_address + n * ERASE_BLOCK_SIZE:04X}")
+                durations.append(0)
+            return durations
+
+        # Durations come back in the transfer buffer, two bytes each
+        batch = min(255, max(1, self._capacity // 2))
+        durations = []
+        while len(durations) < count:
+            current = block_address + len(durations) * ERASE_BLOCK_SIZE
+            result = list(self._rpc.icp_erase_range(current, min(batch, count - len(durations))))
+            durations.extend(result)
+            if not result or result[-1] == ERASE_FAILED:
+                failed = block_address + (len(durations) - 1) * ERASE_BLOCK_SIZE
+                raise OSError(f"Erase failed at 0x{max(failed, current):04X}")
+        return durations
+
 
 class FlashIO(RawIOBase):
     """File-like interface for flash memory.
@@ -64,6 +607,13 @@ class FlashIO(RawIOBase):
     Supports reading and writing with automatic chunking and
     block erase handling. Implements Python's RawIOBase interface.
 
+    With cache=True read() and write() go through a write-back cache of
+    whole sectors. Writes are merged into the cached sector contents and
+    flush() (or leaving the context) erases and reprograms each dirty
+    sector once, so a partial write keeps its neighbouring bytes. The
+    other methods bypass the cache and write back or drop the sectors
+    they touch first.
+
     Example:
         with FlashIO("/dev/ttyACM0") as flash:
             # Read 4KB from address 0
@@ -80,11 +630,28 @@ class FlashIO(RawIOBase):
 
     _device: FlashDevice
     _position: int
+    _caching: bool
+    _cache: dict[int, bytearray]  # Sector address to contents
+    _dirty: set[int]  # Sectors changed since they were read
+    _blank: set[int]  # Sectors erased on the device
 
-    def __init__(self, port: str = "/dev/ttyACM0", baudrate: int = 115200):
+    def __init__(
+        self,
+        port: str = "/dev/ttyACM0",
+        baudrate: int = DEFAULT_BAUDRATE,
+        clock: str | None = None,
+        bulk_baudrate: int = BULK_BAUDRATE,
+        timing: str | None = None,
+        compress: bool = False,
+        cache: bool = False,
+    ):
         super().__init__()
-        self._device = FlashDevice(port, baudrate)
+        self._device = FlashDevice(port, baudrate, clock, bulk_baudrate, timing, compress)
         self._position = 0
+        self._caching = cache
+        self._cache = {}
+        self._dirty = set()
+        self._blank = set()
 
     @override
     def __enter__(self) -> Self:
@@ -99,7 +666,12 @@ class FlashIO(RawIOBase):
         exc_val: BaseException | None,
         traceback: TracebackType | None,
     ) -> None:
-        self._device.close()
+        try:
+            self._write_back(sorted(self._dirty))
+        finally:
+            self._cache.clear()
+            self._dirty.clear()
+            self._device.close()
         super().__exit__(exc_type, exc_val, traceback)
 
     @override
@@ -121,16 +693,16 @@ class FlashIO(RawIOBase):
         size = len(buffer)
         if size == 0:
             return 0
+        if self._caching:
+            buffer[:] = self._cached_read(self._position, size)
+            self._position += size
+            return size
 
         total_read = 0
-        while total_read < size:
-            chunk_size = min(size - total_read, MAX_TRANSFER_SIZE)
-            chunk = self._device.read_chunk(self._position, chunk_size)
-            if not chunk:
-                break
+        for chunk in self._device.read_stream(self._position, size):
             buffer[total_read : total_read + len(chunk)] = chunk
             total_read += len(chunk)
-            self._position += len(chunk)
+        self._position += total_read
 
         return total_read
 
@@ -141,18 +713,15 @@ class FlashIO(RawIOBase):
             return b""
         if size < 0:
             raise ValueError("Must specify a positive read size for flash")
+        if self._caching:
+            data = self._cached_read(self._position, size)
+            self._position += size
+            return data
 
         result = bytearray()
-        remaining = size
-
-        while remaining > 0:
-            chunk_size = min(remaining, MAX_TRANSFER_SIZE)
-            chunk = self._device.read_chunk(self._position, chunk_size)
-            if not chunk:
-                break
+        for chunk in self._device.read_stream(self._position, size):
             result.extend(chunk)
-            self._position += len(chunk)
-            remaining -= len(chunk)
+        self._position += len(result)
 
         return bytes(result)
 
@@ -160,25 +729,122 @@ class FlashIO(RawIOBase):
     def write(self, b: Buffer) -> int:
         """Write data to flash at current position.
 
-        Note: The flash block must be erased before writing.
-        Use erase() to erase blocks as needed.
+        Note: Without the cache the flash block must be erased before
+        writing. Use erase() to erase blocks as needed.
         """
-        data = bytes(memoryview(b))
+        data = memoryview(b).cast("B")
         if not data:
             return 0
+        if self._caching:
+            self._cached_write(self._position, data)
+            self._position += len(data)
+            return len(data)
 
         total_written = 0
-
-        while total_written < len(data):
-            chunk = data[total_written : total_written + MAX_TRANSFER_SIZE]
-            written = self._device.write_chunk(self._position, chunk)
-            if written <= 0:
-                break
+        for written in self._device.write_stream(self._position, data):
             total_written += written
             self._position += written
 
         return total_written
 
+    @override
+    def flush(self) -> None:
+        """Erase and reprogram every dirty cached sector once."""
+        self._write_back(sorted(self._dirty))
+        super().flush()
+
+    def _sectors(self, address: int, size: int) -> range:
+        """Start addresses of the sectors covering a range."""
+        start = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+        return range(start, address + size, ERASE_BLOCK_SIZE)
+
+    def _load(self, address: int, size: int) -> None:
+        """Read the uncached sectors covering a range, one session per run."""
+        missing = [s for s in self._sectors(address, size) if s not in self._cache]
+        while missing:
+            count = 1
+            while count < len(missing) and missing[count] == missing[0] + count * ERASE_BLOCK_SIZE:
+                count += 1
+            data = b"".join(self._device.read_stream(missing[0], count * ERASE_BLOCK_SIZE))
+            for i in range(count):
+                sector = bytearray(data[i * ERASE_BLOCK_SIZE : (i + 1) * ERASE_BLOCK_SIZE])
+                self._cache[missing[i]] = sector
+                if sector.count(0xFF) == ERASE_BLOCK_SIZE:
+                    self._blank.add(missing[i])
+            missing = missing[count:]
+
+    def _cached_read(self, address: int, size: int) -> bytes:
+        """Serve a read from cached sectors, loading the missing ones."""
+        if address + size > FLASH_SIZE:
+            raise ValueError(f"Read past end of flash: 0x{address:04X}+{size}")
+        self._load(address, size)
+        result = bytearray()
+        for sector in self._sectors(address, size):
+            start = max(address, sector) - sector
+            end = min(address + size, sector + ERASE_BLOCK_SIZE) - sector
+            result += self._cache[sector][start:end]
+        return bytes(result)
+
+    def _cached_write(self, address: int, data: memoryview) -> None:
+        """Merge a write into cached sectors, marking the changed ones dirty."""
+        if address + len(data) > FLASH_SIZE:
+            raise ValueError(f"Write past end of flash: 0x{address:04X}+{len(data)}")
+        self._load(address, len(data))
+        for sector in self._sectors(address, len(data)):
+            start = max(address, sector)
+            end = min(address + len(data), sector + ERASE_BLOCK_SIZE)
+            chunk = data[start - address : end - address]
+            contents = self._cache[sector]
+            if contents[start - sector : end - sector] != chunk:
+                contents[start - sector : end - sector] = chunk
+                self._dirty.add(sector)
+
+    def _write_back(self, sectors: list[int]) -> None:
+        """Program dirty sectors, erasing the non-blank ones in runs.
+
+        Args:
+            sectors: Dirty sector addresses, ascending
+        """
+        runs: list[list[int]] = []
+        for sector in sectors:
+            if runs and runs[-1][-1] + ERASE_BLOCK_SIZE == sector:
+                runs[-1].append(sector)
+            else:
+                runs.append([sector])
+
+        for run in runs:
+            start = 0
+            while start < len(run):
+                # Erase consecutive non-blank sectors with one call
+                if run[start] in self._blank:
+                    start += 1
+                    continue
+                count = 1
+                while start + count < len(run) and run[start + count] not in self._blank:
+                    count += 1
+                _ = self._device.erase_blocks(run[start], count)
+                self._blank.update(run[start : start + count])
+                start += count
+
+            data = b"".join(self._cache[sector] for sector in run)
+            for _ in self._device.write_stream(run[0], data):
+                pass
+            for sector in run:
+                self._dirty.discard(sector)
+                if self._cache[sector].count(0xFF) != ERASE_BLOCK_SIZE:
+                    self._blank.discard(sector)
+
+    def _flush_range(self, address: int, size: int) -> None:
+        """Write back the dirty sectors a bypassing read or write touches."""
+        self._write_back([s for s in self._sectors(address, size) if s in self._dirty])
+
+    def _discard_range(self, address: int, size: int) -> None:
+        """Forget cached sectors that are about to change on the device."""
+        for sector in self._sectors(address, size):
+            _ = self._cache.pop(sector, None)
+            self._dirty.discard(sector)
+            self._blank.discard(sector)
+
     @override
     def seek(self, offset: int, whence: int = 0) -> int:
         """Move to a new position in flash.
@@ -220,18 +886,132 @@ class FlashIO(RawIOBase):
         """
         if address is None:
             address = self._position
-        return self._device.erase_block(address)
+        return self.erase_block(address)
+
+    @property
+    def max_write(self) -> int:
+        """Largest chunk write_chunk() accepts on this link."""
+        return self._device.max_write
 
     def read_chunk(self, address: int, size: int) -> bytes:
         """Read a single chunk from flash (up to MAX_TRANSFER_SIZE bytes)."""
+        self._flush_range(address, size)
         return self._device.read_chunk(address, size)
 
+    def read_stream(self, address: int, size: int) -> Iterator[bytes]:
+        """Stream a flash range in one ICP session, yielding chunks."""
+        self._flush_range(address, size)
+        return self._device.read_stream(address, size)
+
+    def codescan_read(self, address: int, size: int) -> Iterator[bytes]:
+        """Stream a flash range over JTAG CODESCAN, yielding chunks."""
+        self._flush_range(address, size)
+        return self._device.codescan_read(address, size)
+
     def write_chunk(self, address: int, data: bytes) -> int:
-        """Write a single chunk to flash (up to MAX_TRANSFER_SIZE bytes)."""
+        """Write a single chunk to flash (up to max_write bytes)."""
+        self._flush_range(address, len(data))
+        self._discard_range(address, len(data))
         return self._device.write_chunk(address, data)
 
+    def write_stream(self, address: int, data: Buffer) -> Iterator[int]:
+        """Write a range, yielding byte counts as they are consumed."""
+        size = len(memoryview(data).cast("B"))
+        self._flush_range(address, size)
+        self._discard_range(address, size)
+        return self._device.write_stream(address, data)
+
+    @property
+    def has_write_verify(self) -> bool:
+        """True if the firmware can program and read back in one call."""
+        return self._device.has_write_verify
+
+    def write_verify(self, address: int, data: Buffer) -> Iterator[int]:
+        """Program a range, reading each segment back in the same session."""
+        size = len(memoryview(data).cast("B"))
+        self._flush_range(address, size)
+        self._discard_range(address, size)
+        return self._device.write_verify(address, data)
+
+    @property
+    def has_crc(self) -> bool:
+        """True if the firmware can checksum flash on the device."""
+        return self._device.has_crc
+
+    def compare(self, address: int, data: Buffer) -> Iterator[tuple[int, int, bool]]:
+        """Compare flash against data by device-side CRC per sector segment."""
+        self._flush_range(address, len(memoryview(data).cast("B")))
+        return self._device.compare(address, data)
+
+    @property
+    def timing(self) -> str:
+        """Name of the active waveform timing profile."""
+        return self._device.timing
+
+    def scan(self, program: bytes) -> bytes:
+        """Run an encoded scan program (see sinojtag.scan) in one call."""
+        return self._device.scan(program)
+
+    @property
+    def has_pipeline(self) -> bool:
+        """True if the firmware runs tagged request pipelines."""
+        return self._device.has_pipeline
+
+    def pipeline(self) -> Pipeline:
+        """Open a request pipeline, writing back and dropping the whole cache first."""
+        self._flush_range(0, FLASH_SIZE)
+        self._discard_range(0, FLASH_SIZE)
+        return self._device.pipeline()
+
+    @property
+    def has_stats(self) -> bool:
+        """True if the firmware was built with profile counters."""
+        return self._device.has_stats
+
+    def stats(self) -> Stats:
+        """Profile counters since the firmware started or reset_stats()."""
+        return self._device.stats()
+
+    def reset_stats(self) -> None:
+        """Zero the profile counters, if the firmware has them."""
+        self._device.reset_stats()
+
+    def headroom(self) -> int | None:
+        """Smallest free RAM between heap and stack since boot, None if unknown."""
+        return self._device.headroom()
+
+    @property
+    def has_image(self) -> bool:
+        """True if the firmware can reach XPAGE banks and the custom block."""
+        return self._device.has_image
+
+    def read_image(self, bank_size: int, banks: int, custom_size: int) -> Iterator[bytes]:
+        """Stream main flash bank by bank then the custom block in one call."""
+        self._flush_range(0, FLASH_SIZE)
+        return self._device.read_image(bank_size, banks, custom_size)
+
+    def erase_region(self, block: int, bank: int, address: int) -> int:
+        """Erase the 1KB sector of a block and bank, returning erase time in ms."""
+        if block == 0 and bank == 0:
+            self._discard_range((address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE, 1)
+        return self._device.erase_region(block, bank, address)
+
+    def write_region(self, block: int, bank: int, address: int, data: Buffer) -> Iterator[int]:
+        """Program erased space of a block and bank, yielding byte counts."""
+        if block == 0 and bank == 0:
+            size = len(memoryview(data).cast("B"))
+            self._flush_range(address, size)
+            self._discard_range(address, size)
+        return self._device.write_region(block, bank, address, data)
+
+    def is_blank(self, address: int, size: int) -> bool:
+        """True if the range reads all 0xFF and needs no erase."""
+        self._flush_range(address, size)
+        return self._device.is_blank(address, size)
+
     def erase_block(self, address: int) -> bool:
         """Erase a single 1KB block at the given address."""
+        self._discard_range(address, 1)
         return self._device.erase_block(address)
 
     def erase_range(self, start: int, size: int) -> int:
@@ -242,18 +1022,39 @@ class FlashIO(RawIOBase):
             size: Number of bytes to cover
 
         Returns:
-            Number of blocks erased
+            Number of blocks erased, blocks that are already blank are skipped
         """
         start_block = (start // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
         end_address = start + size
         blocks_erased = 0
 
-        for addr in range(start_block, end_address, ERASE_BLOCK_SIZE):
-            if self._device.erase_block(addr):
-                blocks_erased += 1
+        for addr, count in self.dirty_runs(start_block, end_address - start_block):
+            blocks_erased += len(self.erase_blocks(addr, count))
 
         return blocks_erased
 
+    def dirty_runs(self, start: int, size: int) -> Iterator[tuple[int, int]]:
+        """Yield (address, block count) for runs of blocks that are not blank."""
+        start_block = (start // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+        run_start, run_count = start_block, 0
+        self._flush_range(start, size)
+
+        for addr in range(start_block, start + size, ERASE_BLOCK_SIZE):
+            if self._device.is_blank(addr, ERASE_BLOCK_SIZE):
+                if run_count:
+                    yield run_start, run_count
+                run_start, run_count = addr + ERASE_BLOCK_SIZE, 0
+            else:
+                run_count += 1
+        if run_count:
+            yield run_start, run_count
+
+    def erase_blocks(self, address: int, count: int) -> list[int]:
+        """Erase consecutive 1KB blocks, returning erase time in ms per block."""
+        block_address = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+        self._discard_range(block_address, count * ERASE_BLOCK_SIZE)
+        return self._device.erase_blocks(address, count)
+
     def program(self, address: int, data: Buffer, erase: bool = True) -> int:
         """Convenience method to erase and write data.
 
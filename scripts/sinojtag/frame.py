@@ -0,0 +1,121 @@
+"""Bulk data frames carried alongside SimpleRPC.
+
+Frames follow a void RPC call on the raw serial connection:
+
+    [length: u16 LE][payload][Fletcher-16: u16 LE]
+
+Host to device frames are answered with a single status byte.
+"""
+
+import struct
+from collections.abc import Iterator
+from enum import IntEnum
+
+from serial import Serial
+
+HEADER = struct.Struct("<H")
+TRAILER = struct.Struct("<H")
+MAX_PAYLOAD = 0xFFFF
+
+# Streamed write flow control, must match BULK_STREAM_* in include/bulk.h
+STREAM_WINDOW = 192
+STREAM_CREDIT = 64
+CREDIT = 0xCC
+
+
+class Status(IntEnum):
+    """Device status byte answering a host to device frame."""
+
+    OK = 0
+    ERR_CHECKSUM = 1
+    ERR_SIZE = 2
+    ERR_TIMEOUT = 3
+    ERR_TARGET = 4
+
+
+def fletcher16(data: bytes | memoryview) -> int:
+    """Fletcher-16 (mod 255) checksum, low byte is the first sum."""
+    a = b = 0
+    for byte in data:
+        a = (a + byte) % 255
+        b = (b + a) % 255
+    return (b << 8) | a
+
+
+def encode(payload: bytes | memoryview) -> bytes:
+    """Build a frame around payload."""
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError(f"Frame payload too large: {len(payload)} bytes")
+    return HEADER.pack(len(payload)) + bytes(payload) + TRAILER.pack(fletcher16(payload))
+
+
+def checked(status: Status) -> None:
+    """Raise OSError unless status is OK."""
+    if status != Status.OK:
+        raise OSError(f"Device rejected frame: {status.name}")
+
+
+def _read_exact(serial: Serial, size: int) -> bytes:
+    """Read exactly size bytes or raise on timeout."""
+    data = bytearray()
+    while len(data) < size:
+        chunk = serial.read(size - len(data))
+        if not chunk:
+            raise OSError(f"Frame timed out after {len(data)} of {size} bytes")
+        data.extend(chunk)
+    return bytes(data)
+
+
+def receive(serial: Serial) -> bytes:
+    """Read a frame from the device and return its checked payload."""
+    (length,) = HEADER.unpack(_read_exact(serial, HEADER.size))
+    payload = _read_exact(serial, length)
+    (checksum,) = TRAILER.unpack(_read_exact(serial, TRAILER.size))
+    if checksum != fletcher16(payload):
+        raise OSError("Frame checksum mismatch")
+    return payload
+
+
+def send(serial: Serial, payload: bytes | memoryview) -> Status:
+    """Send a frame to the device and return its status byte."""
+    _ = serial.write(encode(payload))
+    return Status(_read_exact(serial, 1)[0])
+
+
+def exchange(serial: Serial, payload: bytes | memoryview) -> bytes:
+    """Send a frame to the device and return the payload of the frame answering it."""
+    _ = serial.write(encode(payload))
+    return receive(serial)
+
+
+def send_stream(serial: Serial, payload: bytes | memoryview) -> Iterator[int]:
+    """Send a credit-paced frame, yielding payload bytes as the device consumes them.
+
+    Raises:
+        OSError: If the device answered with an error status.
+    """
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError(f"Frame payload too large: {len(payload)} bytes")
+    view = memoryview(payload)
+
+    sent = min(len(view), STREAM_WINDOW)
+    _ = serial.write(HEADER.pack(len(view)) + bytes(view[:sent]))
+    trailer = TRAILER.pack(fletcher16(view))
+    if sent == len(view):
+        _ = serial.write(trailer)
+
+    while True:
+        byte = _read_exact(serial, 1)[0]
+        if byte != CREDIT:
+            checked(Status(byte))
+            # Bytes past the last full credit were consumed too
+            yield len(view) % STREAM_CREDIT
+            return
+
+        yield STREAM_CREDIT
+        if sent < len(view):
+            end = min(len(view), sent + STREAM_CREDIT)
+            _ = serial.write(bytes(view[sent:end]))
+            sent = end
+            if sent == len(view):
+                _ = serial.write(trailer)
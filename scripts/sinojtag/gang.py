@@ -0,0 +1,125 @@
+"""Gang programming of identical targets from one programmer.
+
+Requires firmware built with SINOJTAG_GANG (the uno_gang environment).
+Every command reaches all sites at once; erase and verify results are
+reported per site.
+"""
+
+import zlib
+from collections.abc import Buffer, Iterator
+from dataclasses import dataclass
+from typing import Self
+
+from simple_rpc import Interface
+
+from . import frame
+from .flash import BULK_BAUDRATE, DEFAULT_BAUDRATE, ERASE_BLOCK_SIZE
+
+
+@dataclass(frozen=True)
+class SiteResult:
+    """Outcome of a gang operation for one site."""
+
+    site: int
+    okay: bool
+
+
+def _mask_results(mask: int, sites: int) -> list[SiteResult]:
+    """Split a firmware site bitmask into per-site results."""
+    return [SiteResult(site, bool(mask & (1 << site))) for site in range(sites)]
+
+
+class GangDevice:
+    """All gang sites behind one SimpleRPC link."""
+
+    _rpc: Interface
+    _bulk_baudrate: int
+    _bulk: bool
+    _sites: int
+    _capacity: int
+
+    def __init__(
+        self,
+        port: str = "/dev/ttyACM0",
+        baudrate: int = DEFAULT_BAUDRATE,
+        bulk_baudrate: int = BULK_BAUDRATE,
+    ):
+        self._rpc = Interface(port, baudrate)
+        self._bulk_baudrate = bulk_baudrate
+        self._bulk = False
+        self._sites = 0
+        self._capacity = 0
+
+    def open(self) -> list[SiteResult]:
+        """Run the entry waveform on every site and check the ICP link.
+
+        Raises:
+            OSError: If the firmware was built without gang support.
+        """
+        if not hasattr(self._rpc, "gang_init"):
+            raise OSError("Firmware was built without SINOJTAG_GANG")
+        self._rpc.gang_init()
+        self._sites = self._rpc.gang_sites()
+        self._capacity = self._rpc.buffer_capacity()
+        if self._bulk_baudrate:
+            self._bulk = self._set_baudrate(self._bulk_baudrate)
+        return _mask_results(self._rpc.gang_verify(), self._sites)
+
+    def close(self) -> None:
+        """Stop driving the targets and restore the default baud rate."""
+        self._rpc.gang_stop()
+        if self._bulk:
+            _ = self._set_baudrate(DEFAULT_BAUDRATE)
+            self._bulk = False
+
+    def __enter__(self) -> Self:
+        return self
+
+    def __exit__(self, *_: object) -> None:
+        self.close()
+
+    def _set_baudrate(self, baudrate: int) -> bool:
+        okay = self._rpc.link_set_baud(baudrate)
+        if okay:
+            serial = self._rpc._connection
+            serial.flush()
+            serial.baudrate = baudrate
+        return okay
+
+    @property
+    def sites(self) -> int:
+        """Number of gang sites."""
+        return self._sites
+
+    def erase(self, address: int, size: int) -> list[SiteResult]:
+        """Erase every block covering the range; a site fails if any block did."""
+        start = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+        okay = (1 << self._sites) - 1
+        for block in range(start, address + size, ERASE_BLOCK_SIZE):
+            okay &= self._rpc.gang_erase(block)
+        return _mask_results(okay, self._sites)
+
+    def write(self, address: int, data: Buffer) -> Iterator[int]:
+        """Program data on every site, yielding byte counts as frames complete.
+
+        Raises:
+            OSError: If the device rejects a frame.
+        """
+        view = memoryview(data).cast("B")
+        offset = 0
+        while offset < len(view):
+            # Frames stay within one sector, like every write sequence
+            current = address + offset
+            sector_end = (current // ERASE_BLOCK_SIZE + 1) * ERASE_BLOCK_SIZE
+            length = min(len(view) - offset, sector_end - current, self._capacity)
+            self._rpc.gang_bulk_write(current)
+            frame.checked(frame.send(self._rpc._connection, view[offset : offset + length]))
+            offset += length
+            yield length
+
+    def verify(self, address: int, data: Buffer) -> list[SiteResult]:
+        """Compare every site against data by device-side CRC-32."""
+        view = memoryview(data).cast("B")
+        expected = zlib.crc32(view)
+        crcs = self._rpc.gang_crc(address, len(view))
+        return [SiteResult(site, crc == expected) for site, crc in enumerate(crcs)]
@@ -2,6 +2,8 @@
 
 from dataclasses import dataclass
 
+SECTOR_SIZE = 1024  # Default coalescing granularity, the target erase block
+
 
 @dataclass
 class IHexSegment:
@@ -138,3 +140,115 @@ def merge_segments(
         result[offset : offset + len(seg.data)] = seg.data
 
     return start_addr, bytes(result)
+
+
+@dataclass(frozen=True)
+class SectorRun:
+    """Consecutive sectors touched by an image and the segments inside them."""
+
+    address: int  # First byte of the first sector
+    count: int  # Number of sectors
+    segments: list[IHexSegment]
+    sector_size: int = SECTOR_SIZE
+
+    @property
+    def size(self) -> int:
+        """Bytes covered by the sectors."""
+        return self.count * self.sector_size
+
+    def image(self, fill: int = 0xFF) -> tuple[int, bytes]:
+        """Data from the first to the last segment byte, gaps filled.
+
+        Returns:
+            (start address, data)
+        """
+        start = self.segments[0].address
+        end = self.segments[-1].address + len(self.segments[-1].data)
+        data = bytearray([fill]) * (end - start)
+        for segment in self.segments:
+            offset = segment.address - start
+            data[offset : offset + len(segment.data)] = segment.data
+        return start, bytes(data)
+
+
+@dataclass(frozen=True)
+class SegmentMap:
+    """Sorted, non-overlapping segments of an image.
+
+    Only the sectors holding data are ever erased or programmed, the gaps
+    between segments are left alone.
+    """
+
+    segments: list[IHexSegment]
+    sector_size: int = SECTOR_SIZE
+
+    @property
+    def size(self) -> int:
+        """Data bytes in the image."""
+        return sum(len(s.data) for s in self.segments)
+
+    def sectors(self) -> list[int]:
+        """Start address of every sector holding image data, ascending."""
+        touched: list[int] = []
+        for segment in self.segments:
+            first = segment.address // self.sector_size
+            last = (segment.address + len(segment.data) - 1) // self.sector_size
+            for sector in range(first, last + 1):
+                if not touched or touched[-1] < sector * self.sector_size:
+                    touched.append(sector * self.sector_size)
+        return touched
+
+    def runs(self) -> list[SectorRun]:
+        """Maximal runs of consecutive touched sectors with their segments."""
+        runs: list[SectorRun] = []
+        for segment in self.segments:
+            first = (segment.address // self.sector_size) * self.sector_size
+            end = segment.address + len(segment.data)
+            last = (end + self.sector_size - 1) // self.sector_size * self.sector_size
+            if runs and first <= runs[-1].address + runs[-1].size:
+                run = runs[-1]
+                count = max(run.count, (last - run.address) // self.sector_size)
+                runs[-1] = SectorRun(
+                    run.address, count, [*run.segments, segment], self.sector_size
+                )
+            else:
+                runs.append(
+                    SectorRun(first, (last - first) // self.sector_size, [segment], self.sector_size)
+                )
+        return runs
+
+    def flatten(self, fill: int = 0xFF) -> tuple[int, bytes]:
+        """The whole image as one range, gaps filled.
+
+        Returns:
+            (start address, data)
+        """
+        return SectorRun(0, 0, self.segments, self.sector_size).image(fill)
+
+
+def segment_map(
+    segments: list[IHexSegment], base_offset: int = 0, sector_size: int = SECTOR_SIZE
+) -> SegmentMap:
+    """Sort segments and merge the ones that touch or overlap.
+
+    Where segments overlap the one starting later wins, equal starts keep
+    file order.
+
+    Raises:
+        ValueError: If there are no segments.
+    """
+    if not segments:
+        raise ValueError("No data in Intel HEX file")
+
+    merged: list[tuple[int, bytearray]] = []
+    for seg in sorted(segments, key=lambda s: s.address):  # Stable, keeps file order
+        address = seg.address + base_offset
+        if merged:
+            start, data = merged[-1]
+            if address <= start + len(data):
+                offset = address - start
+                data[offset : offset + len(seg.data)] = seg.data
+                continue
+        merged.append((address, bytearray(seg.data)))
+
+    return SegmentMap([IHexSegment(a, bytes(d)) for a, d in merged], sector_size)
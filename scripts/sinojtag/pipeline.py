@@ -0,0 +1,210 @@
+"""Tagged request pipeline for the pipeline_run RPC.
+
+Requests are sent ahead of their responses, up to a window of request
+bytes the firmware's UART receive buffer can hold. The device runs them
+back to back while earlier responses drain, so the link and the target
+are busy at the same time. Responses come back in request order.
+
+The firmware leaves the pipeline when no request arrives for a second,
+keep it fed or close it.
+
+Example:
+    with flash.pipeline() as pipe:
+        reads = [pipe.read(a, 256) for a in range(0, 0x1000, 256)]
+        crc = pipe.crc(0x1000, 0x1000)
+    data = b"".join(pipe.result(r) for r in reads)
+"""
+
+from collections import deque
+from collections.abc import Buffer
+from dataclasses import dataclass
+from enum import IntEnum
+from typing import Self
+
+from simple_rpc import Interface
+
+from . import frame
+
+# Must match include/pipeline.h
+WINDOW = 192  # PIPELINE_WINDOW, request frame bytes in flight
+SEQ_NONE = 0xFF  # Sequence ID of responses to undecodable frames
+
+DEPTH = 16  # Requests in flight
+WRITE_CHUNK = 128  # ICP_WRITE data bytes per request
+SECTOR_SIZE = 1024  # Write requests stay within one erase block
+MAX_READ = 0xFFFF - 2  # Longest ICP_READ result, the frame length is u16
+_FRAME_OVERHEAD = frame.HEADER.size + frame.TRAILER.size
+
+
+class Op(IntEnum):
+    """Request opcodes, numbered like pipeline::Op."""
+
+    END = 0x00
+    ICP_READ = 0x01
+    ICP_WRITE = 0x02
+    ICP_ERASE = 0x03
+    ICP_CRC = 0x04
+    TAP_BATCH = 0x05
+
+
+class Status(IntEnum):
+    """Second byte of a response."""
+
+    OK = 0
+    ERR_OPCODE = 1
+    ERR_TRUNCATED = 2
+    ERR_TARGET = 3
+    ERR_FRAME = 4
+
+
+@dataclass(eq=False)
+class Request:
+    """One submitted request, done once its response arrived."""
+
+    seq: int
+    op: Op
+    size: int  # Frame bytes counted against the window
+    status: Status | None = None
+    data: bytes = b""
+
+    @property
+    def done(self) -> bool:
+        """True once the response has been received."""
+        return self.status is not None
+
+
+class Pipeline:
+    """Window of in-flight requests on one SimpleRPC link."""
+
+    _rpc: Interface
+    _pending: deque[Request]
+    _in_flight: int  # Request frame bytes not answered yet
+    _seq: int
+    _open: bool
+
+    def __init__(self, rpc: Interface):
+        self._rpc = rpc
+        self._pending = deque()
+        self._in_flight = 0
+        self._seq = 0
+        self._open = False
+
+    def open(self) -> None:
+        """Switch the link to request frames."""
+        self._rpc.pipeline_run()
+        self._open = True
+
+    def close(self) -> None:
+        """Send END and collect every outstanding response."""
+        if not self._open:
+            return
+        end = self.submit(Op.END)
+        self.wait(end)
+        self._open = False
+
+    def __enter__(self) -> Self:
+        return self
+
+    def __exit__(self, *_: object) -> None:
+        self.close()
+
+    def submit(self, op: Op, operands: Buffer = b"") -> Request:
+        """Send a request once the window has room for it.
+
+        Raises:
+            ValueError: If the request is larger than the window.
+            OSError: If the pipeline is closed or a response was out of order.
+        """
+        if not self._open:
+            raise OSError("Pipeline is not open")
+        payload = bytes((self._seq, op)) + bytes(memoryview(operands).cast("B"))
+        size = len(payload) + _FRAME_OVERHEAD
+        if size > WINDOW:
+            raise ValueError(f"Request of {size} bytes exceeds the {WINDOW} byte window")
+
+        while self._pending and (
+            len(self._pending) >= DEPTH or self._in_flight + size > WINDOW
+        ):
+            self._receive()
+
+        request = Request(self._seq, op, size)
+        _ = self._rpc._connection.write(frame.encode(payload))
+        self._pending.append(request)
+        self._in_flight += size
+        self._seq = (self._seq + 1) % SEQ_NONE
+        return request
+
+    def _receive(self) -> None:
+        """Match the next response to the oldest pending request."""
+        payload = frame.receive(self._rpc._connection)
+        if len(payload) < 2:
+            raise OSError("Truncated pipeline response")
+        seq, status = payload[0], Status(payload[1])
+        if seq == SEQ_NONE and status == Status.ERR_FRAME:
+            self._open = False
+            raise OSError("Device rejected a damaged request frame, pipeline closed")
+
+        request = self._pending.popleft()
+        if request.seq != seq:
+            self._open = False
+            raise OSError(f"Response {seq} out of order, expected {request.seq}")
+        request.status = status
+        request.data = payload[2:]
+        self._in_flight -= request.size
+
+    def wait(self, request: Request) -> None:
+        """Receive responses until request is done."""
+        while not request.done:
+            self._receive()
+
+    def result(self, request: Request) -> bytes:
+        """Wait for a request and return its result bytes.
+
+        Raises:
+            OSError: If the device reported an error.
+        """
+        self.wait(request)
+        assert request.status is not None
+        if request.status != Status.OK:
+            raise OSError(f"{request.op.name} failed: {request.status.name}")
+        return request.data
+
+    def value(self, request: Request) -> int:
+        """Wait for a request and return its result as a little-endian integer."""
+        return int.from_bytes(self.result(request), "little")
+
+    def read(self, address: int, size: int) -> Request:
+        """Queue a flash read, the result is the data.
+
+        Raises:
+            ValueError: If size exceeds MAX_READ.
+        """
+        if size > MAX_READ:
+            raise ValueError(f"Read of {size} bytes exceeds {MAX_READ}")
+        return self.submit(Op.ICP_READ, address.to_bytes(2, "little") + size.to_bytes(2, "little"))
+
+    def write(self, address: int, data: Buffer) -> list[Request]:
+        """Queue programming of erased flash, split into sector-bounded chunks."""
+        view = memoryview(data).cast("B")
+        requests: list[Request] = []
+        offset = 0
+        while offset < len(view):
+            current = address + offset
+            sector_end = (current // SECTOR_SIZE + 1) * SECTOR_SIZE
+            length = min(len(view) - offset, sector_end - current, WRITE_CHUNK)
+            operands = current.to_bytes(2, "little") + bytes(view[offset : offset + length])
+            requests.append(self.submit(Op.ICP_WRITE, operands))
+            offset += length
+        return requests
+
+    def erase(self, address: int) -> Request:
+        """Queue a sector erase, value() is the erase time in ms."""
+        return self.submit(Op.ICP_ERASE, address.to_bytes(2, "little"))
+
+    def crc(self, address: int, size: int) -> Request:
+        """Queue a device-side CRC-32 (zlib) of a range, value() is the CRC."""
+        return self.submit(Op.ICP_CRC, address.to_bytes(2, "little") + size.to_bytes(4, "little"))
+
+    def scan(self, program: bytes) -> Request:
+        """Queue a scan program (see sinojtag.scan), the result is as from tap_batch."""
+        return self.submit(Op.TAP_BATCH, program)
@@ -0,0 +1,123 @@
+"""Differential flash programming planner.
+
+Compares the target's current flash contents against a new image one
+sector at a time and only erases and programs the sectors that differ.
+"""
+
+from collections.abc import Buffer, Iterator
+from dataclasses import dataclass
+from enum import Enum
+
+from .flash import ERASE_BLOCK_SIZE, FlashIO
+
+
+class Action(Enum):
+    """What the planner does with one sector segment."""
+
+    SKIP = "skip"  # Already holds the image data
+    PROGRAM = "program"  # Blank, programmed without an erase
+    REWRITE = "rewrite"  # Erased and programmed
+
+
+@dataclass(frozen=True)
+class Step:
+    """One sector-bounded segment of the image and its action.
+
+    For a REWRITE of a partially covered sector, address and data span the
+    whole sector with the bytes outside the image read back from the target.
+    """
+
+    address: int
+    data: bytes
+    action: Action
+
+
+@dataclass(frozen=True)
+class Plan:
+    """Ordered steps covering an image."""
+
+    steps: list[Step]
+
+    def count(self, action: Action) -> int:
+        """Number of steps with the given action."""
+        return sum(1 for step in self.steps if step.action is action)
+
+    @property
+    def program_size(self) -> int:
+        """Bytes that will be written to the target."""
+        return sum(len(s.data) for s in self.steps if s.action is not Action.SKIP)
+
+    def summary(self) -> str:
+        """One line description of the plan."""
+        return (
+            f"{self.count(Action.SKIP)} sector(s) unchanged, "
+            f"{self.count(Action.REWRITE)} rewritten, "
+            f"{self.count(Action.PROGRAM)} blank"
+        )
+
+
+def _segments(address: int, view: memoryview) -> Iterator[tuple[int, memoryview]]:
+    """Split an image at sector boundaries."""
+    offset = 0
+    while offset < len(view):
+        current = address + offset
+        sector_end = (current // ERASE_BLOCK_SIZE + 1) * ERASE_BLOCK_SIZE
+        length = min(sector_end - current, len(view) - offset)
+        yield current, view[offset : offset + length]
+        offset += length
+
+
+def _read(flash: FlashIO, address: int, size: int) -> bytes:
+    """Read a range in one session."""
+    return b"".join(flash.read_stream(address, size))
+
+
+def _rewrite(flash: FlashIO, address: int, data: memoryview) -> Step:
+    """Build a REWRITE step, keeping sector bytes outside the image."""
+    if len(data) == ERASE_BLOCK_SIZE:
+        return Step(address, bytes(data), Action.REWRITE)
+
+    sector = (address // ERASE_BLOCK_SIZE) * ERASE_BLOCK_SIZE
+    merged = bytearray(_read(flash, sector, ERASE_BLOCK_SIZE))
+    offset = address - sector
+    merged[offset : offset + len(data)] = data
+    return Step(sector, bytes(merged), Action.REWRITE)
+
+
+def plan(flash: FlashIO, address: int, data: Buffer) -> Plan:
+    """Compare the target against an image and plan the minimal update.
+
+    Uses device-side sector CRCs when the firmware supports them and reads
+    each segment back otherwise.
+    """
+    view = memoryview(data).cast("B")
+    steps: list[Step] = []
+
+    if flash.has_crc:
+        # Keyed like _segments(), a segment compare() didn't report as
+        # matching is treated as changed
+        differs = {(a, n): not ok for a, n, ok in flash.compare(address, view)}
+        current = None
+    else:
+        differs = None
+        current = _read(flash, address, len(view))
+
+    for segment, expected in _segments(address, view):
+        offset = segment - address
+        if differs is not None:
+            changed = differs.get((segment, len(expected)), True)
+            blank = changed and flash.is_blank(segment, len(expected))
+        else:
+            assert current is not None
+            actual = current[offset : offset + len(expected)]
+            changed = actual != expected
+            blank = changed and actual.count(0xFF) == len(actual)
+
+        if not changed:
+            steps.append(Step(segment, bytes(expected), Action.SKIP))
+        elif blank:
+            steps.append(Step(segment, bytes(expected), Action.PROGRAM))
+        else:
+            steps.append(_rewrite(flash, segment, expected))
+
+    return Plan(steps)
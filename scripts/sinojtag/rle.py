@@ -0,0 +1,98 @@
+"""Run-length codec for the compressed bulk read and write paths.
+
+Must match include/rle.h. Each op is a control byte c followed by a
+literal of c + 1 bytes when c < 0x80, or by one byte repeated
+(c & 0x7F) + 3 times when c >= 0x80.
+"""
+
+from collections.abc import Buffer, Iterator
+
+RUN = 0x80
+MAX_LITERAL = 128
+MIN_RUN = 3
+MAX_RUN = 130
+
+
+def _ops(view: memoryview) -> Iterator[tuple[int, bytes]]:
+    """Encode data, yielding (decoded length, encoded bytes) per op."""
+    literal = bytearray()
+    n = 0
+    while n < len(view):
+        value = view[n]
+        run = 1
+        while n + run < len(view) and run < MAX_RUN and view[n + run] == value:
+            run += 1
+
+        if run >= MIN_RUN:
+            if literal:
+                yield len(literal), bytes((len(literal) - 1,)) + literal
+                literal = bytearray()
+            yield run, bytes((RUN | (run - MIN_RUN), value))
+        else:
+            for _ in range(run):
+                literal.append(value)
+                if len(literal) == MAX_LITERAL:
+                    yield len(literal), bytes((len(literal) - 1,)) + literal
+                    literal = bytearray()
+        n += run
+
+    if literal:
+        yield len(literal), bytes((len(literal) - 1,)) + literal
+
+
+def encode(data: Buffer) -> bytes:
+    """Encode data in one piece."""
+    return b"".join(op for _, op in _ops(memoryview(data).cast("B")))
+
+
+def frames(data: Buffer, capacity: int) -> Iterator[tuple[int, int, bytes]]:
+    """Encode data as payloads of at most capacity bytes.
+
+    Yields:
+        (offset of the first decoded byte, decoded length, encoded payload)
+
+    Raises:
+        ValueError: If capacity can't hold the longest op.
+    """
+    if capacity < MAX_LITERAL + 1:
+        raise ValueError(f"Frame capacity must be at least {MAX_LITERAL + 1} bytes")
+    offset = 0
+    payload = bytearray()
+    decoded = 0
+    for length, op in _ops(memoryview(data).cast("B")):
+        if payload and len(payload) + len(op) > capacity:
+            yield offset, decoded, bytes(payload)
+            offset += decoded
+            payload = bytearray()
+            decoded = 0
+        payload += op
+        decoded += length
+    if payload:
+        yield offset, decoded, bytes(payload)
+
+
+def decode(data: Buffer) -> bytes:
+    """Decode one or more whole ops.
+
+    Raises:
+        ValueError: If the data ends inside an op.
+    """
+    view = memoryview(data).cast("B")
+    out = bytearray()
+    n = 0
+    while n < len(view):
+        control = view[n]
+        n += 1
+        if control & RUN:
+            if n >= len(view):
+                raise ValueError("Encoded data ends inside a run")
+            out += bytes((view[n],)) * ((control & ~RUN) + MIN_RUN)
+            n += 1
+            continue
+
+        count = control + 1
+        if len(view) - n < count:
+            raise ValueError("Encoded data ends inside a literal")
+        out += view[n : n + count]
+        n += count
+    return bytes(out)
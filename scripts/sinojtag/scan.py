@@ -0,0 +1,139 @@
+"""Batched TAP scan programs for the tap_batch RPC.
+
+A program runs on the device in one call, so scripted bring-up sequences
+pay the serial round trip once instead of per TAP operation.
+
+Example:
+    program = ScanProgram().reset().ir(0x0E).dr(0, 32, capture=True)
+    (idcode,) = program.run(flash)
+"""
+
+from enum import IntEnum
+from typing import Protocol, Self
+
+# Opcodes, must match scan::Op in include/scan.h
+OP_RESET = 0x01
+OP_GOTO = 0x02
+OP_IDLE = 0x03
+OP_IR = 0x04
+OP_DR = 0x05
+OP_CODESCAN = 0x06
+CAPTURE = 0x80
+
+
+class TapState(IntEnum):
+    """JTAG TAP states, numbered like SimpleJTAG::Tap::State."""
+
+    TEST_LOGIC_RESET = 0
+    RUN_TEST_IDLE = 1
+    SELECT_DR_SCAN = 2
+    CAPTURE_DR = 3
+    SHIFT_DR = 4
+    EXIT1_DR = 5
+    PAUSE_DR = 6
+    EXIT2_DR = 7
+    UPDATE_DR = 8
+    SELECT_IR_SCAN = 9
+    CAPTURE_IR = 10
+    SHIFT_IR = 11
+    EXIT1_IR = 12
+    PAUSE_IR = 13
+    EXIT2_IR = 14
+    UPDATE_IR = 15
+
+
+class Status(IntEnum):
+    """First byte of a tap_batch result."""
+
+    OK = 0
+    ERR_OPCODE = 1
+    ERR_TRUNCATED = 2
+    ERR_OVERFLOW = 3
+
+
+class ScanTarget(Protocol):
+    """Anything that can run an encoded program, e.g. FlashDevice or FlashIO."""
+
+    def scan(self, program: bytes) -> bytes: ...
+
+
+class ScanProgram:
+    """Builder for a tap_batch program.
+
+    Each method appends one op and returns the program so calls chain.
+    Captures are returned by run() in program order.
+    """
+
+    _code: bytearray
+    _widths: list[int]  # Result bytes per capture
+
+    def __init__(self) -> None:
+        self._code = bytearray()
+        self._widths = []
+
+    def reset(self) -> Self:
+        """Force Test-Logic-Reset."""
+        self._code.append(OP_RESET)
+        return self
+
+    def goto(self, state: TapState) -> Self:
+        """Move to a TAP state along the shortest path."""
+        self._code += bytes((OP_GOTO, state))
+        return self
+
+    def idle(self, count: int) -> Self:
+        """Emit idle clocks with TMS low, 0-255."""
+        self._code += bytes((OP_IDLE, count))
+        return self
+
+    def ir(self, value: int, capture: bool = False) -> Self:
+        """Shift the instruction register."""
+        self._code += bytes((OP_IR | (CAPTURE if capture else 0), value))
+        if capture:
+            self._widths.append(1)
+        return self
+
+    def dr(self, value: int, bits: int, capture: bool = False) -> Self:
+        """Shift a data register of 1 to 32 bits."""
+        if not 1 <= bits <= 32:
+            raise ValueError(f"DR width must be 1..32 bits, got {bits}")
+        width = (bits + 7) // 8
+        self._code += bytes((OP_DR | (CAPTURE if capture else 0), bits))
+        self._code += (value & ((1 << bits) - 1)).to_bytes(width, "little")
+        if capture:
+            self._widths.append(width)
+        return self
+
+    def codescan(self, address: int) -> Self:
+        """Read one flash byte via CODESCAN, always captured."""
+        self._code.append(OP_CODESCAN)
+        self._code += address.to_bytes(2, "little")
+        self._widths.append(1)
+        return self
+
+    def encode(self) -> bytes:
+        """The program as sent to tap_batch."""
+        return bytes(self._code)
+
+    def decode(self, result: bytes) -> list[int]:
+        """Split a tap_batch result into captured values.
+
+        Raises:
+            OSError: If the device stopped on an error.
+        """
+        if not result:
+            raise OSError("Empty tap_batch result")
+        status = Status(result[0])
+        if status != Status.OK:
+            raise OSError(f"Scan program failed: {status.name}")
+
+        values: list[int] = []
+        offset = 1
+        for width in self._widths:
+            values.append(int.from_bytes(result[offset : offset + width], "little"))
+            offset += width
+        return values
+
+    def run(self, target: ScanTarget) -> list[int]:
+        """Run the program on the device and return the captures."""
+        return self.decode(target.scan(self.encode()))
@@ -0,0 +1,114 @@
+"""Programming one image on many programmers at once.
+
+Each serial port gets its own FlashIO on a worker thread. The image is
+parsed once and every worker reads the same memoryview, so a station of
+N programmers holds one copy of it. Serial I/O releases the GIL, so
+throughput scales with the number of ports.
+"""
+
+import glob
+import time
+from collections.abc import Buffer, Callable, Iterable
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass
+
+from .flash import BULK_BAUDRATE, DEFAULT_BAUDRATE, FlashIO
+
+# Called from worker threads with (port, bytes just written)
+Progress = Callable[[str, int], None]
+
+
+@dataclass(frozen=True)
+class Link:
+    """Link settings shared by every programmer."""
+
+    baudrate: int = DEFAULT_BAUDRATE
+    clock: str | None = None
+    bulk_baudrate: int = BULK_BAUDRATE
+    timing: str | None = None
+    compress: bool = False
+
+
+@dataclass(frozen=True)
+class PortResult:
+    """Outcome of programming through one port."""
+
+    port: str
+    okay: bool
+    written: int
+    elapsed: float  # Seconds
+    error: str | None = None
+
+
+def expand_ports(patterns: Iterable[str]) -> list[str]:
+    """Expand glob patterns like /dev/ttyACM*, keeping plain names as given."""
+    ports: list[str] = []
+    for pattern in patterns:
+        matches = sorted(glob.glob(pattern)) if glob.has_magic(pattern) else [pattern]
+        ports.extend(p for p in matches if p not in ports)
+    return ports
+
+
+def _matches(flash: FlashIO, address: int, image: memoryview) -> bool:
+    """Compare flash against the image, by device-side CRC when available."""
+    if flash.has_crc:
+        return all(okay for _, _, okay in flash.compare(address, image))
+    return b"".join(flash.read_stream(address, len(image))) == image
+
+
+def program(
+    port: str,
+    link: Link,
+    address: int,
+    image: memoryview,
+    erase: bool = True,
+    verify: bool = True,
+    progress: Progress | None = None,
+) -> PortResult:
+    """Erase, write and verify through one port, never raising OSError."""
+    start = time.perf_counter()
+    written = 0
+    try:
+        with FlashIO(
+            port, link.baudrate, link.clock, link.bulk_baudrate, link.timing, link.compress
+        ) as flash:
+            if erase:
+                _ = flash.erase_range(address, len(image))
+            for count in flash.write_stream(address, image):
+                written += count
+                if progress is not None:
+                    progress(port, count)
+            if verify and not _matches(flash, address, image):
+                return PortResult(
+                    port, False, written, time.perf_counter() - start, "Verification failed"
+                )
+    except OSError as e:
+        return PortResult(port, False, written, time.perf_counter() - start, str(e))
+    return PortResult(port, True, written, time.perf_counter() - start)
+
+
+def program_all(
+    ports: list[str],
+    link: Link,
+    address: int,
+    data: Buffer,
+    erase: bool = True,
+    verify: bool = True,
+    progress: Progress | None = None,
+    workers: int | None = None,
+) -> list[PortResult]:
+    """Program every port in parallel, results in port order.
+
+    Args:
+        workers: Ports programmed at once, all of them by default.
+    """
+    if not ports:
+        return []
+    image = memoryview(data).cast("B")  # Shared read-only by every worker
+    with ThreadPoolExecutor(max_workers=workers or len(ports)) as pool:
+        return list(
+            pool.map(
+                lambda port: program(port, link, address, image, erase, verify, progress),
+                ports,
+            )
+        )
@@ -0,0 +1,76 @@
+"""Firmware hot-path profile counters.
+
+Requires firmware built with SINOJTAG_PROFILE (the uno_profile
+environment). Each phase counts the CPU cycles spent in it, less the time
+spent in phases nested inside it, so the phases add up to the total.
+"""
+
+from collections.abc import Sequence
+from dataclasses import dataclass
+from typing import Self
+
+# Phase names in stats_get order, must match profile::Phase in include/profile.h
+PHASES = (
+    "phy_init",
+    "phy_reset",
+    "phy_mode",
+    "icp_init",
+    "icp_read",
+    "icp_write",
+    "icp_erase",
+    "tap_ir",
+    "tap_dr",
+    "bulk_io",
+    "rpc",
+)
+
+
+@dataclass(frozen=True)
+class PhaseStats:
+    """Cycles and calls counted for one phase."""
+
+    name: str
+    cycles: int
+    calls: int
+
+
+@dataclass(frozen=True)
+class Stats:
+    """A snapshot of every phase counter."""
+
+    clock: int  # Device F_CPU, cycles per second
+    phases: list[PhaseStats]
+
+    @classmethod
+    def decode(cls, values: Sequence[int]) -> Self:
+        """Build from a stats_get result.
+
+        Raises:
+            OSError: If the result doesn't match the known phases.
+        """
+        if len(values) != 1 + 2 * len(PHASES):
+            raise OSError(f"Unexpected stats_get result of {len(values)} values")
+        phases = [
+            PhaseStats(name, values[1 + 2 * n], values[2 + 2 * n])
+            for n, name in enumerate(PHASES)
+        ]
+        return cls(values[0], phases)
+
+    @property
+    def total_cycles(self) -> int:
+        """Cycles spent in any phase."""
+        return sum(p.cycles for p in self.phases)
+
+    def format(self) -> str:
+        """Breakdown table, busiest phase first."""
+        total = self.total_cycles or 1
+        lines = [f"{'Phase':<10} {'Calls':>10} {'Time (ms)':>12} {'Share':>7}"]
+        for phase in sorted(self.phases, key=lambda p: p.cycles, reverse=True):
+            if not phase.calls:
+                continue
+            ms = phase.cycles * 1000 / self.clock
+            lines.append(
+                f"{phase.name:<10} {phase.calls:>10} {ms:>12.3f} {phase.cycles / total:>7.1%}"
+            )
+        lines.append(f"{'total':<10} {'':>10} {self.total_cycles * 1000 / self.clock:>12.3f}")
+        return "\n".join(lines)
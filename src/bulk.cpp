@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bulk.h"
+
+#include <Arduino.h>
+#include <SimpleJTAG/clock.h>
+
+#include "profile.h"
+
+#ifdef SERIAL_RX_BUFFER_SIZE
+static_assert(BULK_STREAM_WINDOW + 8 <= SERIAL_RX_BUFFER_SIZE,
+              "Streamed write window must fit the UART receive buffer");
+#endif
+
+namespace {
+  /** Rates that are exact at 16 MHz with U2X (HardwareSerial picks U2X). */
+  static constexpr uint32_t supported_bauds[] = {
+    115200UL, 250000UL, 500000UL, 1000000UL,
+#if !SIMPLEJTAG_TIMER_TCK
+    // Two bytes arrive within one Timer2 TCK bit's interrupt blackout
+    2000000UL,
+#endif
+  };
+
+#if SIMPLEJTAG_TIMER_TCK
+  // The USART buffers two received bytes while interrupts are off
+  constexpr bool fits_blackout() {
+    for (auto baud : supported_bauds) {
+      if (2 * 10 * F_CPU / baud <= SimpleJTAG::clock::Timer2::MAX_BLACKOUT) return false;
+    }
+    return true;
+  }
+  static_assert(fits_blackout(), "Timer2 TCK blackout overruns the USART at a supported baud rate");
+#endif
+
+  uint32_t pending_baud = 0;
+}
+
+namespace bulk {
+
+uint8_t buffer[BULK_BUFFER_SIZE];
+
+Writer::Writer(uint16_t length) {
+  Serial.write(static_cast<uint8_t>(length & 0xFF));
+  Serial.write(static_cast<uint8_t>(length >> 8));
+}
+
+void Writer::put(uint8_t byte) {
+  profile::Scope scope(profile::Phase::BULK_IO);
+  sum_.add(byte);
+  Serial.write(byte);
+}
+
+void Writer::finish() {
+  const uint16_t sum = sum_.value();
+  Serial.write(static_cast<uint8_t>(sum & 0xFF));
+  Serial.write(static_cast<uint8_t>(sum >> 8));
+}
+
+bool Reader::raw(uint8_t& byte) {
+  profile::Scope scope(profile::Phase::BULK_IO);
+  const uint32_t start = millis();
+  while (!Serial.available()) {
+    if (millis() - start >= BULK_FRAME_TIMEOUT_MS) return false;
+  }
+  byte = static_cast<uint8_t>(Serial.read());
+  return true;
+}
+
+bool Reader::begin() {
+  uint8_t lo, hi;
+  if (!raw(lo) || !raw(hi)) return false;
+  length_ = static_cast<uint16_t>(hi << 8 | lo);
+  received_ = 0;
+  return true;
+}
+
+bool Reader::get(uint8_t& byte) {
+  if (received_ >= length_ || !raw(byte)) return false;
+  ++received_;
+  sum_.add(byte);
+  return true;
+}
+
+bool Reader::finish() {
+  uint8_t lo, hi;
+  if (received_ != length_ || !raw(lo) || !raw(hi)) return false;
+  return static_cast<uint16_t>(hi << 8 | lo) == sum_.value();
+}
+
+void Reader::skip() {
+  uint8_t byte;
+  while (received_ < length_ && get(byte)) {}
+  (void)finish();
+}
+
+Status receive(uint16_t& size) {
+  size = 0;
+  Reader frame;
+  if (!frame.begin()) return Status::ERR_TIMEOUT;
+
+  if (frame.length() > sizeof(buffer)) {
+    frame.skip();
+    return Status::ERR_SIZE;
+  }
+  for (uint16_t n = 0; n < frame.length(); ++n) {
+    if (!frame.get(buffer[n])) return Status::ERR_TIMEOUT;
+  }
+  if (!frame.finish()) return Status::ERR_CHECKSUM;
+
+  size = frame.length();
+  return Status::OK;
+}
+
+void send(const uint8_t* data, uint16_t size) {
+  Writer frame(size);
+  for (uint16_t n = 0; n < size; ++n) {
+    frame.put(data[n]);
+  }
+  frame.finish();
+  Serial.flush();
+}
+
+void send_status(Status status) {
+  Serial.write(static_cast<uint8_t>(status));
+  Serial.flush();
+}
+
+void send_credit() {
+  Serial.write(CREDIT);
+}
+
+bool set_baud(uint32_t baud) {
+  for (auto supported : supported_bauds) {
+    if (supported == baud) {
+      pending_baud = baud;
+      return true;
+    }
+  }
+  return false;
+}
+
+void poll() {
+  if (!pending_baud) return;
+
+  // Let the RPC response drain at the old rate first
+  Serial.flush();
+  Serial.end();
+  Serial.begin(pending_baud);
+  pending_baud = 0;
+}
+
+}  // namespace bulk
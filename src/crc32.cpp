@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "crc32.h"
+
+#include <avr/pgmspace.h>
+
+namespace {
+  /** CRC-32 of each nibble value, polynomial 0xEDB88320 */
+  const uint32_t nibble_table[16] PROGMEM = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL,
+  };
+
+  inline uint32_t lookup(uint32_t crc) {
+    return pgm_read_dword(&nibble_table[crc & 0x0F]);
+  }
+}
+
+void Crc32::add(uint8_t byte) {
+  crc_ ^= byte;
+  crc_ = (crc_ >> 4) ^ lookup(crc_);
+  crc_ = (crc_ >> 4) ^ lookup(crc_);
+}
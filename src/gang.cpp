@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gang.h"
+
+#if SINOJTAG_GANG
+
+#include <avr/io.h>
+#include <util/delay.h>
+#include <SimpleJTAG/config.h>
+#include <SimpleJTAG/phy.h>
+
+#include "sinowealth/icp.h"
+#include "sinowealth/sequence.h"
+#include "sinowealth/timing.h"
+
+namespace {
+  using namespace config;
+  using Pins = SimpleJTAG::Phy;
+  using CommandSet = sinowealth::ICP::CommandSet;
+  namespace sequence = sinowealth::sequence;
+
+  static_assert(tck::port_letter != 'B' && tck::port_letter != 'C' &&
+                tms::port_letter != 'B' && tms::port_letter != 'C',
+                "Gang TDI/TDO use PORTB/PORTC, TCK and TMS must be elsewhere");
+
+  inline void tck(bool state) { Pins::write_port(tck::port, tck::index, state); }
+  inline void tms(bool state) { Pins::write_port(tms::port, tms::index, state); }
+  inline bool vref() { return Pins::read_pin(vref::pin, vref::index); }
+
+  /** Drive every site's TDI with one write. */
+  inline void tdi(bool state) {
+    if (state) { PORTB |= gang::ALL; }
+    else { PORTB &= static_cast<uint8_t>(~gang::ALL); }
+  }
+
+  /** Sample every site's TDO with one read. */
+  inline uint8_t tdo() { return PINC & gang::ALL; }
+
+  /** Pin writers for sequence::entry(), TDI drives every site. */
+  struct Lines {
+    static void tck(bool state) { ::tck(state); }
+    static void tms(bool state) { ::tms(state); }
+    static void tdi(bool state) { ::tdi(state); }
+  };
+
+  /** One TCK pulse, TDO sampled on the high phase. */
+  inline uint8_t clock() {
+    tck(false);
+    Clock::delay_half();
+    tck(true);
+    Clock::delay_half();
+    const uint8_t sample = tdo();
+    tck(false);
+    return sample;
+  }
+}  // namespace
+
+namespace gang {
+
+// --- Phy ---
+
+void Phy::init(bool wait_vref) {
+  sinowealth::timing::dispatch([this, wait_vref](auto t) { init<decltype(t)>(wait_vref); });
+}
+
+template <typename Timing>
+void Phy::init(bool wait_vref) {
+  if (_mode != Mode::NOT_INITIALIZED) return;
+
+  // All pins to input with pull-ups off
+  stop();
+
+  if (wait_vref) {
+    // Block on Vref, flash LED on PB5 to signal waiting
+    DDRB |= _BV(5);
+    uint8_t count = 0;
+    while (!::vref()) {
+      if (++count == 0) {
+        PORTB ^= _BV(5);
+      }
+      _delay_us(200);
+    }
+    PORTB &= ~_BV(5);
+  }
+
+  // Enable outputs, TDO inputs per site
+  Pins::set_ddr(tck::ddr, tck::index, true);
+  Pins::set_ddr(tms::ddr, tms::index, true);
+  DDRB |= ALL;
+  DDRC &= static_cast<uint8_t>(~ALL);
+  if (tdo_pullup) { PORTC |= ALL; }
+
+  // TDI pulses reach every site
+  sequence::entry<Timing, Lines>();
+
+  _mode = Mode::READY;
+}
+
+void Phy::stop() {
+  Pins::set_ddr(tck::ddr, tck::index, false);
+  Pins::set_ddr(tms::ddr, tms::index, false);
+  Pins::set_ddr(vref::ddr, vref::index, false);
+  Pins::write_port(tck::port, tck::index, false);
+  Pins::write_port(tms::port, tms::index, false);
+  Pins::write_port(vref::port, vref::index, false);
+  DDRB &= static_cast<uint8_t>(~ALL);
+  PORTB &= static_cast<uint8_t>(~ALL);
+  DDRC &= static_cast<uint8_t>(~ALL);
+  PORTC &= static_cast<uint8_t>(~ALL);
+  _mode = Mode::NOT_INITIALIZED;
+}
+
+Phy::Mode Phy::mode(Mode mode) {
+  if (_mode == mode || _mode == Mode::NOT_INITIALIZED) return _mode;
+  if (mode != Mode::ICP && mode != Mode::READY) return _mode;
+
+  // Have to be in ready state to switch modes
+  if (_mode != Mode::READY) reset();
+  if (mode == Mode::READY) return _mode;
+
+  // Mode byte is sent LSb with an extra 2 zero bits.
+  uint16_t packet = static_cast<uint8_t>(mode);
+  ::tms(false);
+  for (uint8_t i = 0; i < 10; ++i) {
+    ::tdi(packet & 0x1);
+    (void)::clock();
+    packet >>= 1;
+  }
+  _mode = mode;
+
+  return mode;
+}
+
+Phy::Mode Phy::reset() {
+  if (_mode == Mode::ICP) {
+    // Pulsing TMS with clock high exits ICP
+    ::tck(true);
+    ::tms(true);
+    Clock::delay_half();
+    ::tms(false);
+    Clock::delay_half();
+    _mode = Mode::READY;
+  }
+  return _mode;
+}
+
+// --- ICP ---
+
+void ICP::init() {
+  sinowealth::timing::dispatch([this](auto t) { init<decltype(t)>(); });
+}
+
+template <typename Timing>
+void ICP::init() {
+  _delay_us(Timing::ICP_INIT_US);
+  ping();
+}
+
+void ICP::send_byte(uint8_t byte) {
+  // bytes go out MSb-first, plus 1 extra clock
+  ::tms(false);
+  for (uint8_t bit = 0x80; bit; bit >>= 1) {
+    ::tdi(byte & bit);
+    (void)::clock();
+  }
+  ::tdi(false);
+  (void)::clock();
+}
+
+void ICP::receive_byte(uint8_t* bytes) {
+  // Sample all sites per clock, sort the bits out per site afterwards
+  uint8_t samples[8];
+  ::tms(false);
+  ::tdi(false);
+  for (uint8_t i = 0; i < 8; ++i) {
+    samples[i] = ::clock();
+  }
+  (void)::clock();
+
+  // and come back LSb-first
+  for (uint8_t site = 0; site < SITES; ++site) {
+    const uint8_t mask = static_cast<uint8_t>(1u << site);
+    uint8_t byte = 0;
+    for (uint8_t i = 8; i-- > 0;) {
+      byte = static_cast<uint8_t>((byte << 1) | ((samples[i] & mask) ? 1 : 0));
+    }
+    bytes[site] = byte;
+  }
+}
+
+void ICP::ping() {
+  send_byte(CommandSet::PING);
+  send_byte(0xFF);
+}
+
+uint8_t ICP::verify() {
+  set_address(0xFF69);
+
+  uint8_t low[SITES];
+  uint8_t high[SITES];
+  send_byte(CommandSet::GET_IB_OFFSET);
+  receive_byte(low);
+  receive_byte(high);  // discard high byte
+
+  uint8_t okay = 0;
+  for (uint8_t site = 0; site < SITES; ++site) {
+    if (low[site] == 0x69) okay |= static_cast<uint8_t>(1u << site);
+  }
+  return okay;
+}
+
+void ICP::set_address(uint16_t address) {
+  send_byte(CommandSet::SET_IB_OFFSET_L);
+  send_byte(static_cast<uint8_t>(address & 0xFF));
+  send_byte(CommandSet::SET_IB_OFFSET_H);
+  send_byte(static_cast<uint8_t>((address >> 8) & 0xFF));
+}
+
+void ICP::begin_read(uint16_t address) {
+  set_address(address);
+  send_byte(CommandSet::READ_FLASH);
+}
+
+bool ICP::write_flash(uint16_t address, const uint8_t* buffer, uint16_t size) {
+  return sinowealth::timing::dispatch([&](auto t) {
+    return write_flash<decltype(t)>(address, buffer, size);
+  });
+}
+
+template <typename Timing>
+bool ICP::write_flash(uint16_t address, const uint8_t* buffer, uint16_t size) {
+  return sequence::write<Timing>(*this, address, buffer, size, true);
+}
+
+uint8_t ICP::erase_flash(uint16_t address) {
+  return sinowealth::timing::dispatch([&](auto t) {
+    return erase_flash<decltype(t)>(address);
+  });
+}
+
+template <typename Timing>
+uint8_t ICP::erase_flash(uint16_t address) {
+  set_address(address);
+
+  send_byte(CommandSet::SET_IB_DATA);
+  send_byte(0x00);
+
+  // Erase unlock sequence
+  send_byte(CommandSet::ERASE_UNLOCK);
+  for (auto b : CommandSet::PREAMBLE) {
+    send_byte(b);
+  }
+
+  send_byte(0x00);
+  // Until the slowest site is done, with the busy-then-high rule per site
+  (void)sequence::wait_erase<Timing>([] { return ::tdo(); }, ALL);
+  send_byte(0x00);
+  const uint8_t status = ::tdo();
+  send_byte(0x00);
+
+  return status;
+}
+
+}  // namespace gang
+
+#endif  // SINOJTAG_GANG
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "headroom.h"
+
+#include <avr/io.h>
+
+#include "bulk.h"
+
+#ifndef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE 64
+#endif
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64
+#endif
+
+// The buffers sized by this firmware have to leave room for the core's
+// and simpleRPC's state, the profile counters, heap Vectors and the call
+// stack. link_headroom reports how much of it a workload actually left.
+static constexpr uint16_t STATIC_BUFFERS =
+    BULK_BUFFER_SIZE + SERIAL_RX_BUFFER_SIZE + SERIAL_TX_BUFFER_SIZE;
+static constexpr uint16_t RESERVE = 640;
+static_assert(RAMEND - RAMSTART + 1 - STATIC_BUFFERS >= RESERVE,
+              "Static buffers leave too little RAM for the heap and stack");
+
+extern char __heap_start;
+extern char* __brkval;
+
+namespace {
+  static constexpr uint8_t PATTERN = 0xC5;
+
+  /** Bytes below the stack pointer left alone for paint()'s own frame. */
+  static constexpr uint8_t FRAME = 32;
+
+  /** Heap end, the heap starts out empty. */
+  uint8_t* heap_end() {
+    return reinterpret_cast<uint8_t*>(__brkval ? __brkval : &__heap_start);
+  }
+
+  uint8_t* stack_end() { return reinterpret_cast<uint8_t*>(SP); }
+}  // namespace
+
+namespace headroom {
+
+void paint() {
+  uint8_t* const end = stack_end() - FRAME;
+  for (uint8_t* p = heap_end(); p < end; ++p) *p = PATTERN;
+}
+
+uint16_t untouched() {
+  // The heap may have shrunk again, scan from its start
+  uint16_t longest = 0;
+  uint16_t run = 0;
+  uint8_t* const end = stack_end();
+  for (uint8_t* p = reinterpret_cast<uint8_t*>(&__heap_start); p < end; ++p) {
+    run = (*p == PATTERN) ? run + 1 : 0;
+    if (run > longest) longest = run;
+  }
+  return longest;
+}
+
+}  // namespace headroom
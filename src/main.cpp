@@ -17,7 +17,9 @@
 
 #include <Arduino.h>
 
+#include "gang.h"
 #include "rpc.h"
+#include "session.h"
 #include "sinowealth/phy.h"
 #include "sinowealth/tap.h"
 #include "sinowealth/icp.h"
@@ -25,6 +27,11 @@
 auto _phy = sinowealth::Phy();
 auto _tap = sinowealth::Tap();
 auto _icp = sinowealth::ICP();
+auto _session = Session(_phy, _tap, _icp);
+#if SINOJTAG_GANG
+auto _gang_phy = gang::Phy();
+auto _gang_icp = gang::ICP();
+#endif
 
 void setup() {
   rpc::setup();
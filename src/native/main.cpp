@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Native entry point: runs the firmware's PHY, TAP and ICP code against
+ * the simulated target and reports the TCK clocks each operation costs.
+ * Clock counts are exact and repeatable, simulated time only adds up the
+ * delays the code asked for.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sim/target.h"
+#include "sim/time.h"
+#include "sinowealth/icp.h"
+#include "sinowealth/phy.h"
+#include "sinowealth/tap.h"
+
+namespace {
+  using Mode = sinowealth::Phy::Mode;
+
+  sinowealth::Phy phy;
+  sinowealth::Tap tap;
+  sinowealth::ICP icp;
+
+  uint8_t buffer[sinowealth::ICP::SECTOR_SIZE];
+  int failures = 0;
+
+  /** Run fn and print its TCK cycles and simulated time, ok is its result. */
+  template <typename Fn>
+  void measure(const char* name, uint32_t bytes, Fn fn) {
+    const uint32_t cycles = sim::target.cycles();
+    const double start = sim::now_ns;
+    const bool ok = fn();
+    const uint32_t spent = sim::target.cycles() - cycles;
+
+    printf("%-24s %10lu %12.1f", name, static_cast<unsigned long>(spent),
+           (sim::now_ns - start) / 1e3);
+    if (bytes) printf(" %8.2f", static_cast<double>(spent) / bytes);
+    else printf(" %8s", "-");
+    printf("  %s\n", ok ? "ok" : "FAILED");
+    if (!ok) ++failures;
+  }
+
+  /** True if the first size bytes of buffer equal expected. */
+  bool matches(const uint8_t* expected, uint16_t size) {
+    return memcmp(buffer, expected, size) == 0;
+  }
+}  // namespace
+
+int main() {
+  auto& flash = sim::target.flash;
+  for (uint32_t n = 0; n < sizeof(flash[0]); ++n) {
+    flash[0][n] = static_cast<uint8_t>(n * 7 + (n >> 8));
+    flash[1][n] = static_cast<uint8_t>(~n);
+  }
+  for (uint16_t n = 0; n < sim::Target::CUSTOM_SIZE; ++n) {
+    sim::target.custom[n] = static_cast<uint8_t>(n ^ 0x5A);
+  }
+
+  printf("%-24s %10s %12s %8s\n", "operation", "tck", "sim us", "tck/B");
+
+  measure("entry", 0, [] {
+    phy.init();
+    return sim::target.mode() == sim::Target::Mode::READY;
+  });
+
+  measure("jtag mode", 0, [] {
+    phy.mode(Mode::JTAG);
+    return sim::target.mode() == sim::Target::Mode::JTAG;
+  });
+  measure("jtag init", 0, [] { return tap.init() == sinowealth::Status::OK; });
+  measure("jtag idcode", 0, [] { return tap.IDCODE() == sim::Target::IDCODE; });
+  measure("codescan read 256", 256, [] {
+    uint16_t n = 0;
+    tap.CODESCAN.read(0x0100, 256, [&n](uint8_t byte) { buffer[n++] = byte; });
+    return matches(&sim::target.flash[0][0x0100], 256);
+  });
+
+  measure("icp mode", 0, [] {
+    phy.reset();
+    phy.mode(Mode::ICP);
+    icp.init();
+    return sim::target.mode() == sim::Target::Mode::ICP;
+  });
+  measure("icp verify", 0, [] { return icp.verify(); });
+  measure("icp read 1K", 1024, [] {
+    icp.read_flash(0x0000, buffer, 1024);
+    return matches(&sim::target.flash[0][0x0000], 1024);
+  });
+  measure("icp erase", 0, [] {
+    uint16_t ms = 0;
+    return icp.erase_flash(0x0400, &ms) && ms > 0 && icp.blank_check(0x0400, 1024);
+  });
+  measure("icp erase no busy", 0, [] {
+    // TDO never drops, the wait must run to the timeout instead of ending
+    sim::target.signal_busy = false;
+    uint16_t ms = 0;
+    const bool okay = icp.erase_flash(0x0400, &ms);
+    sim::target.signal_busy = true;
+    return okay && ms == sinowealth::timing::Conservative::ERASE_TIMEOUT_MS;
+  });
+  measure("icp write 1K", 1024, [] {
+    for (uint16_t n = 0; n < 1024; ++n) buffer[n] = static_cast<uint8_t>(n * 13);
+    return icp.write_flash(0x0400, buffer, 1024) &&
+           matches(&sim::target.flash[0][0x0400], 1024);
+  });
+  measure("icp write sparse 1K", 1024, [] {
+    // Two programmed islands in a blank sector
+    memset(buffer, 0xFF, sizeof(buffer));
+    memset(buffer + 16, 0x00, 64);
+    memset(buffer + 900, 0x12, 32);
+    return icp.erase_flash(0x0800) && icp.write_flash(0x0800, buffer, 1024, true) &&
+           matches(&sim::target.flash[0][0x0800], 1024);
+  });
+  measure("icp read bank 1 256", 256, [] {
+    icp.set_bank(1);
+    icp.read_flash(0x0000, buffer, 256);
+    icp.set_bank(0);
+    return matches(&sim::target.flash[1][0x0000], 256);
+  });
+  measure("icp read custom 256", 256, [] {
+    icp.begin_read(0x0000, sinowealth::ICP::Block::CUSTOM);
+    for (uint16_t n = 0; n < 256; ++n) buffer[n] = icp.receive_byte();
+    return matches(sim::target.custom, 256);
+  });
+
+  measure("exit", 0, [] {
+    phy.reset();
+    return sim::target.mode() == sim::Target::Mode::READY;
+  });
+  phy.stop();
+
+  if (failures) printf("%d operation(s) FAILED\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <SimpleJTAG/config.h>
+
+#include "sim/target.h"
+#include "sim/time.h"
+#include "sinowealth/icp.h"
+#include "sinowealth/tap.h"
+#include "sinowealth/timing.h"
+
+namespace {
+  using namespace config;
+  using CommandSet = sinowealth::ICP::CommandSet;
+  using sinowealth::detail::bit_reverse_8;
+  using sinowealth::detail::bit_reverse_16;
+
+  static_assert(tck::port_letter == 'D' && tms::port_letter == 'D' &&
+                tdi::port_letter == 'D' && tdo::port_letter == 'D' &&
+                vref::port_letter == 'D',
+                "Simulated target is wired to PORTD");
+
+  // TMS pulses of the entry waveform, counted with TCK high
+  constexpr uint16_t ENTRY_PULSES = sinowealth::timing::Conservative::ENTRY_TMS +
+                                    sinowealth::timing::Conservative::ENTRY_TMS_TRAIN;
+
+  // Consecutive TMS high clocks that drop JTAG back to READY
+  constexpr uint8_t JTAG_EXIT = 35;
+
+  constexpr uint8_t MODE_JTAG = 0xA5;
+  constexpr uint8_t MODE_ICP = 0x69;
+  constexpr uint8_t MODE_BITS = 10;
+
+  constexpr uint8_t IR_CAPTURE = 0b0001;
+
+  inline bool bit(uint8_t value, uint8_t index) { return value & _BV(index); }
+
+  void portd_write(uint8_t value) {
+    sim::target.drive(bit(value, tck::index), bit(value, tms::index),
+                      bit(value, tdi::index));
+  }
+
+  // Target powered, TDO from the model, everything else reads back PORTD
+  uint8_t pind_read(uint8_t) {
+    uint8_t value = sim::portd.latch();
+    value &= static_cast<uint8_t>(~_BV(tdo::index));
+    if (sim::target.tdo()) value |= _BV(tdo::index);
+    return value | _BV(vref::index);
+  }
+
+  // Writing ones to PINx toggles PORTx
+  void pind_write(uint8_t value) { sim::portd ^= value; }
+}  // namespace
+
+namespace sim {
+
+Register portb, ddrb, pinb;
+Register portc, ddrc, pinc;
+Register portd{nullptr, &portd_write}, ddrd, pind{&pind_read, &pind_write};
+
+Target target;
+
+Target::Target() {
+  memset(flash, 0xFF, sizeof(flash));
+  memset(custom, 0xFF, sizeof(custom));
+}
+
+void Target::drive(bool tck, bool tms, bool tdi) {
+  if (tck && !tck_) {
+    ++cycles_;
+    rising(tms, tdi);
+  } else if (tck && tck_ && tms != tms_) {
+    // TMS edges with TCK high: the entry train, and the ICP exit pulse
+    if (mode_ == Mode::OFF) {
+      if (tms && entry_pulses_ < ENTRY_PULSES) {
+        ++entry_pulses_;
+      } else if (!tms && entry_pulses_ == ENTRY_PULSES) {
+        enter_ready();
+      }
+    } else if (mode_ == Mode::ICP && tms) {
+      enter_ready();
+    }
+  }
+  tck_ = tck;
+  tms_ = tms;
+}
+
+bool Target::tdo() const {
+  if (mode_ == Mode::ICP && signal_busy && now_ns < busy_until_) return false;
+  return tdo_;
+}
+
+void Target::rising(bool tms, bool tdi) {
+  switch (mode_) {
+    case Mode::READY:
+      // Mode byte LSb-first with TMS low, then 2 padding bits
+      if (tms) break;
+      mode_packet_ |= static_cast<uint16_t>(tdi) << mode_bits_;
+      if (++mode_bits_ < MODE_BITS) break;
+
+      if (static_cast<uint8_t>(mode_packet_) == MODE_JTAG) {
+        mode_ = Mode::JTAG;
+        state_ = State::TestLogicReset;
+        ir_ = static_cast<uint8_t>(SimpleJTAG::Tap::InstructionSet::IDCODE);
+        tms_run_ = 0;
+      } else if (static_cast<uint8_t>(mode_packet_) == MODE_ICP) {
+        mode_ = Mode::ICP;
+        icp_ = Icp::COMMAND;
+        bit_ = 0;
+        in_ = 0;
+        out_ = 0xFF;
+      }
+      mode_packet_ = 0;
+      mode_bits_ = 0;
+      break;
+
+    case Mode::JTAG: jtag_clock(tms, tdi); break;
+    case Mode::ICP: icp_clock(tdi); break;
+    default: break;
+  }
+}
+
+void Target::enter_ready() {
+  mode_ = Mode::READY;
+  mode_packet_ = 0;
+  mode_bits_ = 0;
+  tdo_ = true;
+}
+
+// --- JTAG ---
+
+void Target::jtag_clock(bool tms, bool tdi) {
+  tms_run_ = tms ? tms_run_ + 1 : 0;
+  if (tms_run_ == JTAG_EXIT) {
+    enter_ready();
+    return;
+  }
+
+  // Capture and shift act on the edge that leaves the state, TDO presents
+  // the bit shifted out until the next rising edge.
+  switch (state_) {
+    case State::CaptureIR: ir_shift_ = IR_CAPTURE; break;
+    case State::ShiftIR:
+      tdo_ = ir_shift_ & 0x01;
+      ir_shift_ = static_cast<uint8_t>((ir_shift_ >> 1) | (tdi << (IR_BITS - 1)));
+      break;
+    case State::CaptureDR: dr_shift_ = dr_capture(); break;
+    case State::ShiftDR:
+      tdo_ = dr_shift_ & 0x01;
+      dr_shift_ = (dr_shift_ >> 1) | (static_cast<uint64_t>(tdi) << (dr_bits() - 1));
+      break;
+    default: break;
+  }
+
+  state_ = SimpleJTAG::Tap::next_state(state_, tms);
+  switch (state_) {
+    case State::TestLogicReset:
+      ir_ = static_cast<uint8_t>(SimpleJTAG::Tap::InstructionSet::IDCODE);
+      break;
+    case State::UpdateIR: ir_ = ir_shift_; break;
+    case State::UpdateDR: dr_update(); break;
+    default: break;
+  }
+}
+
+uint8_t Target::dr_bits() const {
+  switch (ir_) {
+    case sinowealth::Tap::InstructionSet::CODESCAN: return 30;
+    case sinowealth::Tap::InstructionSet::DEBUG: return 4;
+    case sinowealth::Tap::InstructionSet::CONFIG: return 64;
+    case sinowealth::Tap::InstructionSet::HALT: return 8;
+    case SimpleJTAG::Tap::InstructionSet::IDCODE: return 16;
+    default: return 1;  // BYPASS
+  }
+}
+
+uint64_t Target::dr_capture() const {
+  switch (ir_) {
+    case sinowealth::Tap::InstructionSet::CODESCAN:
+      return static_cast<uint64_t>(bit_reverse_8(codescan_data_)) << 22;
+    case sinowealth::Tap::InstructionSet::CONFIG: return 0x01;  // op_complete
+    case SimpleJTAG::Tap::InstructionSet::IDCODE: return IDCODE;
+    default: return 0;
+  }
+}
+
+void Target::dr_update() {
+  if (ir_ != sinowealth::Tap::InstructionSet::CODESCAN) return;
+
+  // Data comes back with the next scan
+  const uint16_t address = bit_reverse_16(static_cast<uint16_t>(dr_shift_));
+  const uint8_t ctrl = bit_reverse_8(static_cast<uint8_t>(((dr_shift_ >> 16) & 0x3F) << 2));
+  if (ctrl == sinowealth::Tap::CODESCAN::READ) {
+    codescan_data_ = flash[0][address];
+  }
+}
+
+// --- ICP ---
+
+void Target::icp_clock(bool tdi) {
+  // 8 data clocks, TDI MSb-first and TDO LSb-first, then 1 trailing clock
+  if (bit_ < 8) {
+    in_ = static_cast<uint8_t>((in_ << 1) | tdi);
+    tdo_ = (out_ >> bit_) & 0x01;
+  }
+  if (++bit_ < 9) return;
+
+  const uint8_t byte = in_;
+  bit_ = 0;
+  in_ = 0;
+  icp_byte(byte);
+}
+
+void Target::icp_byte(uint8_t byte) {
+  switch (icp_) {
+    case Icp::COMMAND: icp_command(byte); break;
+
+    case Icp::OPERAND:
+      switch (command_) {
+        case CommandSet::SET_IB_OFFSET_L: address_ = (address_ & 0xFF00) | byte; break;
+        case CommandSet::SET_IB_OFFSET_H:
+          address_ = static_cast<uint16_t>((address_ & 0x00FF) | (byte << 8));
+          break;
+        case CommandSet::SET_IB_DATA: data_ = byte; break;
+        case CommandSet::SET_XPAGE: bank_ = byte; break;
+        case CommandSet::SET_EXTENDED: custom_ = byte != 0; break;
+        default: break;  // PING
+      }
+      icp_ = Icp::COMMAND;
+      break;
+
+    case Icp::OUTPUT:
+      // Zeros clock out the next byte, anything else is the next command
+      if (byte == 0) {
+        out_ = icp_next();
+      } else {
+        out_ = 0xFF;
+        icp_ = Icp::COMMAND;
+        icp_command(byte);
+      }
+      break;
+
+    case Icp::UNLOCK:
+      if (byte != CommandSet::PREAMBLE[preamble_]) {
+        icp_ = Icp::COMMAND;
+      } else if (++preamble_ == sizeof(CommandSet::PREAMBLE)) {
+        if (unlock_ == CommandSet::WRITE_UNLOCK) {
+          cell(address_++) &= data_;
+          icp_ = Icp::WRITE;
+        } else {
+          icp_ = Icp::ERASE;
+        }
+      }
+      break;
+
+    case Icp::WRITE:
+      data_ = byte;
+      icp_ = Icp::STROBE;
+      break;
+
+    case Icp::STROBE:
+      // WRITE_TERM's 0xAA ends the sequence, its trailing zeros are no-ops
+      if (byte == 0) {
+        cell(address_++) &= data_;
+        icp_ = Icp::WRITE;
+      } else {
+        icp_ = Icp::COMMAND;
+      }
+      break;
+
+    case Icp::ERASE:
+      if (custom_) {
+        memset(custom, 0xFF, sizeof(custom));
+      } else {
+        memset(&cell(address_ & ~(SECTOR_SIZE - 1)), 0xFF, SECTOR_SIZE);
+      }
+      busy_until_ = now_ns + ERASE_NS;
+      icp_ = Icp::COMMAND;
+      break;
+  }
+}
+
+void Target::icp_command(uint8_t byte) {
+  switch (byte) {
+    case CommandSet::SET_IB_OFFSET_L:
+    case CommandSet::SET_IB_OFFSET_H:
+    case CommandSet::SET_IB_DATA:
+    case CommandSet::SET_XPAGE:
+    case CommandSet::SET_EXTENDED:
+    case CommandSet::PING:
+      command_ = byte;
+      icp_ = Icp::OPERAND;
+      break;
+
+    case CommandSet::GET_IB_OFFSET:
+    case CommandSet::READ_FLASH:
+    case CommandSet::READ_CUSTOM:
+      command_ = byte;
+      output_count_ = 0;
+      icp_ = Icp::OUTPUT;
+      out_ = icp_next();
+      break;
+
+    case CommandSet::WRITE_UNLOCK:
+    case CommandSet::ERASE_UNLOCK:
+      unlock_ = byte;
+      preamble_ = 0;
+      icp_ = Icp::UNLOCK;
+      break;
+
+    default: break;  // Padding zeros and unknown commands
+  }
+}
+
+uint8_t Target::icp_next() {
+  switch (command_) {
+    case CommandSet::GET_IB_OFFSET:
+      return static_cast<uint8_t>(output_count_++ == 0 ? address_ : address_ >> 8);
+    case CommandSet::READ_CUSTOM: return custom[address_++ % CUSTOM_SIZE];
+    default: return flash[bank_ % BANKS][address_++];
+  }
+}
+
+uint8_t& Target::cell(uint16_t address) {
+  if (custom_) return custom[address % CUSTOM_SIZE];
+  return flash[bank_ % BANKS][address];
+}
+
+}  // namespace sim
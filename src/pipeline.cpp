@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pipeline.h"
+
+#include <Arduino.h>
+
+#include "crc32.h"
+#include "scan.h"
+
+#ifdef SERIAL_RX_BUFFER_SIZE
+static_assert(PIPELINE_WINDOW + 8 <= SERIAL_RX_BUFFER_SIZE,
+              "Pipeline window must fit the UART receive buffer");
+#endif
+
+namespace {
+  using pipeline::Status;
+
+  /** Bounds-checked little-endian reader over a request's operands. */
+  class Operands {
+   public:
+    Operands(const uint8_t* data, uint16_t size) : data_(data), size_(size) {}
+
+    bool get(uint8_t bytes, uint32_t& value) {
+      if (size_ - pos_ < bytes) return false;
+      value = 0;
+      for (uint8_t n = 0; n < bytes; ++n) {
+        value |= static_cast<uint32_t>(data_[pos_++]) << (8 * n);
+      }
+      return true;
+    }
+
+    /** Bytes after the fixed operands. */
+    const uint8_t* rest() const { return data_ + pos_; }
+    uint16_t remaining() const { return size_ - pos_; }
+
+   private:
+    const uint8_t* data_;
+    uint16_t size_;
+    uint16_t pos_ = 0;
+  };
+
+  /** Start a response frame, the result follows through put(). */
+  bulk::Writer respond(uint8_t seq, Status status, uint16_t length = 0) {
+    bulk::Writer frame(length + 2);
+    frame.put(seq);
+    frame.put(static_cast<uint8_t>(status));
+    return frame;
+  }
+
+  /** Send a response without a result. */
+  void reply(uint8_t seq, Status status) { respond(seq, status).finish(); }
+
+  /** Append a little-endian field to a response. */
+  void put(bulk::Writer& frame, uint8_t bytes, uint32_t value) {
+    for (uint8_t n = 0; n < bytes; ++n) frame.put(static_cast<uint8_t>(value >> (8 * n)));
+  }
+
+  /** Longest result after seq and status that the u16 frame length holds. */
+  static constexpr uint16_t MAX_RESULT = 0xFFFF - 2;
+
+  /** Clamp length so address + length stays inside the 64K ICP space. */
+  template <typename T>
+  T clamp(uint16_t address, T length) {
+    const uint32_t limit = 0x10000UL - address;
+    return length > limit ? static_cast<T>(limit) : length;
+  }
+
+  class Executor {
+   public:
+    Executor(Session& session, sinowealth::Tap& tap, sinowealth::ICP& icp)
+        : session_(session), tap_(tap), icp_(icp) {}
+
+    /** Run one request held in bulk::buffer. @return false after END. */
+    bool execute(uint16_t size) {
+      const uint8_t seq = bulk::buffer[0];
+      if (size < 2) {
+        reply(seq, Status::ERR_TRUNCATED);
+        return true;
+      }
+      Operands args(bulk::buffer + 2, size - 2);
+
+      switch (bulk::buffer[1]) {
+        case pipeline::END:
+          reply(seq, Status::OK);
+          return false;
+        case pipeline::ICP_READ: read(seq, args); break;
+        case pipeline::ICP_WRITE: write(seq, args); break;
+        case pipeline::ICP_ERASE: erase(seq, args); break;
+        case pipeline::ICP_CRC: crc(seq, args); break;
+        case pipeline::TAP_BATCH: batch(seq, args, size); break;
+        default: reply(seq, Status::ERR_OPCODE); break;
+      }
+      return true;
+    }
+
+   private:
+    void read(uint8_t seq, Operands& args) {
+      uint32_t address, length;
+      if (!args.get(2, address) || !args.get(2, length)) {
+        reply(seq, Status::ERR_TRUNCATED);
+        return;
+      }
+      if (!session_.icp()) {
+        reply(seq, Status::ERR_TARGET);
+        return;
+      }
+
+      // Bytes go out as they are clocked in, no buffering
+      uint16_t count = clamp(address, static_cast<uint16_t>(length));
+      if (count > MAX_RESULT) count = MAX_RESULT;
+      auto frame = respond(seq, Status::OK, count);
+      icp_.begin_read(static_cast<uint16_t>(address));
+      for (uint16_t n = 0; n < count; ++n) frame.put(icp_.receive_byte());
+      session_.release();
+      frame.finish();
+    }
+
+    void write(uint8_t seq, Operands& args) {
+      uint32_t address;
+      if (!args.get(2, address) || args.remaining() == 0) {
+        reply(seq, Status::ERR_TRUNCATED);
+        return;
+      }
+      if (!session_.icp()) {
+        reply(seq, Status::ERR_TARGET);
+        return;
+      }
+
+      const bool okay = icp_.write_flash(static_cast<uint16_t>(address), args.rest(),
+                                         clamp(address, args.remaining()), true);
+      session_.release();
+      reply(seq, okay ? Status::OK : Status::ERR_TARGET);
+    }
+
+    void erase(uint8_t seq, Operands& args) {
+      uint32_t address;
+      if (!args.get(2, address)) {
+        reply(seq, Status::ERR_TRUNCATED);
+        return;
+      }
+      if (!session_.icp()) {
+        reply(seq, Status::ERR_TARGET);
+        return;
+      }
+
+      uint16_t duration = 0;
+      const bool okay = icp_.erase_flash(static_cast<uint16_t>(address), &duration);
+      session_.release();
+      auto frame = respond(seq, okay ? Status::OK : Status::ERR_TARGET, 2);
+      put(frame, 2, duration);
+      frame.finish();
+    }
+
+    void crc(uint8_t seq, Operands& args) {
+      uint32_t address, length;
+      if (!args.get(2, address) || !args.get(4, length)) {
+        reply(seq, Status::ERR_TRUNCATED);
+        return;
+      }
+      if (!session_.icp()) {
+        reply(seq, Status::ERR_TARGET);
+        return;
+      }
+
+      length = clamp(address, length);
+      Crc32 crc;
+      icp_.begin_read(static_cast<uint16_t>(address));
+      for (uint32_t n = 0; n < length; ++n) crc.add(icp_.receive_byte());
+      session_.release();
+      auto frame = respond(seq, Status::OK, 4);
+      put(frame, 4, crc.value());
+      frame.finish();
+    }
+
+    void batch(uint8_t seq, Operands& args, uint16_t size) {
+      // Earlier ICP requests leave the PHY in ICP mode
+      if (session_.jtag() != sinowealth::Status::OK) {
+        reply(seq, Status::ERR_TARGET);
+        return;
+      }
+
+      // Captures go to the transfer buffer after the request
+      uint8_t* out = bulk::buffer + size;
+      uint16_t written = 0;
+      const auto status = scan::run(tap_, args.rest(), args.remaining(), out,
+                                    sizeof(bulk::buffer) - size, written);
+      session_.release();
+
+      auto frame = respond(seq, Status::OK, written + 1);
+      frame.put(static_cast<uint8_t>(status));
+      for (uint16_t n = 0; n < written; ++n) frame.put(out[n]);
+      frame.finish();
+    }
+
+    Session& session_;
+    sinowealth::Tap& tap_;
+    sinowealth::ICP& icp_;
+  };
+}  // namespace
+
+namespace pipeline {
+
+void run(Session& session, sinowealth::Tap& tap, sinowealth::ICP& icp) {
+  // Hold the mode across requests unless the host already does
+  const bool held = session.is_open();
+  if (!held) (void)session.open();
+
+  Executor executor(session, tap, icp);
+  for (;;) {
+    uint16_t size;
+    const auto status = bulk::receive(size);
+    if (status == bulk::Status::ERR_TIMEOUT) break;
+    if (status != bulk::Status::OK) {
+      reply(SEQ_NONE, Status::ERR_FRAME);
+      break;
+    }
+    if (!executor.execute(size)) break;
+  }
+
+  if (!held) session.close();
+  Serial.flush();
+}
+
+}  // namespace pipeline
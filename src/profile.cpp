@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "profile.h"
+
+#if SINOJTAG_PROFILE
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+namespace {
+  profile::Counter counters[static_cast<uint8_t>(profile::Phase::COUNT)];
+
+  /** Innermost open scope. */
+  profile::Scope* top = nullptr;
+
+  /** Upper 16 bits of the cycle count. */
+  volatile uint16_t overflows = 0;
+}
+
+ISR(TIMER1_OVF_vect) { ++overflows; }
+
+namespace profile {
+
+void init() {
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);  // Normal mode, no prescaler
+  TCNT1 = 0;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 = _BV(TOIE1);
+}
+
+uint32_t now() {
+  uint16_t high = 0, low = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    high = overflows;
+    low = TCNT1;
+    // Overflow pending but not serviced yet, low already wrapped
+    if ((TIFR1 & _BV(TOV1)) && low < 0x8000) ++high;
+  }
+  return static_cast<uint32_t>(high) << 16 | low;
+}
+
+void reset() {
+  for (auto& c : counters) c = Counter{};
+}
+
+const Counter& counter(Phase phase) {
+  return counters[static_cast<uint8_t>(phase)];
+}
+
+Scope::Scope(Phase phase) : phase_(phase), parent_(top) {
+  top = this;
+  start_ = now();
+}
+
+Scope::~Scope() {
+  const uint32_t elapsed = now() - start_;
+  auto& c = counters[static_cast<uint8_t>(phase_)];
+  c.cycles += elapsed - nested_;
+  ++c.calls;
+
+  top = parent_;
+  if (parent_) parent_->nested_ += elapsed;
+}
+
+}  // namespace profile
+
+#endif
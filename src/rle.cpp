@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rle.h"
+
+namespace rle {
+
+void Encoder::put(uint8_t byte) {
+  if (run_ && byte == value_ && run_ < MAX_RUN) {
+    ++run_;
+    return;
+  }
+  emit_run();
+  value_ = byte;
+  run_ = 1;
+}
+
+void Encoder::flush() { emit_run(); }
+
+void Encoder::emit_run() {
+  if (run_ >= MIN_RUN) {
+    literal_ = 0;
+    out_[size_++] = static_cast<uint8_t>(RUN | (run_ - MIN_RUN));
+    out_[size_++] = value_;
+  } else {
+    // Too short to pay for a run op
+    for (uint8_t n = 0; n < run_; ++n) literal(value_);
+  }
+  run_ = 0;
+}
+
+void Encoder::literal(uint8_t byte) {
+  if (literal_ == 0 || literal_ == MAX_LITERAL) {
+    control_ = size_++;
+    literal_ = 0;
+  }
+  out_[size_++] = byte;
+  out_[control_] = literal_++;
+}
+
+}  // namespace rle
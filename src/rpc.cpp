@@ -21,6 +21,15 @@
 #include <simpleRPC.h>
 #include <vector.tcc>
 
+#include "bulk.h"
+#include "crc32.h"
+#include "gang.h"
+#include "headroom.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "rle.h"
+#include "scan.h"
+#include "session.h"
 #include "sinowealth/tap.h"
 #include "sinowealth/phy.h"
 #include "sinowealth/icp.h"
@@ -29,16 +38,44 @@
 #define UART_BAUD 115200UL
 #endif
 
+/** Synthetic loopback RPCs for the host benchmark, see env:uno_bench. */
+#ifndef SINOJTAG_BENCH
+#define SINOJTAG_BENCH 0
+#endif
+
 using namespace SimpleJTAG;
 extern sinowealth::Tap _tap;
 extern sinowealth::Phy _phy;
 extern sinowealth::ICP _icp;
+extern Session _session;
 
 namespace phy {
   void init() {
     _phy.init();
   }
 
+  bool attach() {
+    if (!_phy.resume()) {
+      _phy.init();
+      return false;
+    }
+
+    // A still powered target may have been left in ICP or JTAG mode, leaving
+    // it through READY either way costs far less than the entry waveform.
+    bool okay = _session.icp() && _icp.verify();
+    _session.release();
+    if (!okay) {
+      const auto status = _session.jtag();
+      okay = status == sinowealth::Status::OK;
+      _session.release();
+    }
+    if (okay) return true;
+
+    _phy.stop();
+    _phy.init();
+    return false;
+  }
+
   bool reset() {
     return _phy.reset() == sinowealth::Phy::Mode::READY;
   }
@@ -46,13 +83,57 @@ namespace phy {
   void stop() {
     _phy.stop();
   }
+
+  void set_clock(uint8_t loops) {
+#if SIMPLEJTAG_TIMER_TCK
+    // Longer half-periods would stretch the interrupt blackout per bit
+    if (loops > config::Clock::MAX_LOOPS) loops = config::Clock::MAX_LOOPS;
+#endif
+    config::Clock::loops = loops;
+  }
+
+  uint8_t get_clock() {
+    return config::Clock::loops;
+  }
+
+  bool set_timing(uint8_t profile) {
+    using sinowealth::timing::Profile;
+    if (profile >= static_cast<uint8_t>(Profile::COUNT)) return false;
+    sinowealth::timing::active = static_cast<Profile>(profile);
+    if (_phy.mode() == sinowealth::Phy::Mode::NOT_INITIALIZED) return true;
+
+    // Re-enter ICP with the new profile, a part that can't keep up falls
+    // back to the conservative timing.
+    _phy.reset();
+    bool okay = _session.icp();
+    for (uint8_t n = 0; n < 8 && okay; ++n) okay = _icp.verify();
+    if (!okay) sinowealth::timing::active = Profile::CONSERVATIVE;
+    _phy.reset();
+    _session.release();
+    return okay;
+  }
+
+  uint8_t get_timing() {
+    return static_cast<uint8_t>(sinowealth::timing::active);
+  }
+}
+
+namespace link {
+  bool set_baud(uint32_t baud) { return bulk::set_baud(baud); }
+  uint16_t buffer_capacity() { return sizeof(bulk::buffer); }
+  uint16_t headroom() { return headroom::untouched(); }
+}
+
+namespace session {
+  bool open() { return _session.open(); }
+  void close() { _session.close(); }
+  void run_pipeline() { pipeline::run(_session, _tap, _icp); }
 }
 
 namespace tap {
 
 uint8_t init() {
-  _phy.mode(sinowealth::Phy::Mode::JTAG);
-  return static_cast<uint8_t>(_tap.init());
+  return static_cast<uint8_t>(_session.jtag());
 }
 
 uint8_t state() {
@@ -74,37 +155,48 @@ uint8_t ir(uint8_t out) {
 
 uint32_t dr(uint32_t out, uint8_t bits) {
   uint32_t in = 0;
-  switch (bits) {
-    case 4:
-      _tap.DR<4, uint32_t>(out, &in);
-      break;
-    case 8:
-      _tap.DR<8, uint32_t>(out, &in);
-      break;
-    case 16:
-      _tap.DR<16, uint32_t>(out, &in);
-      break;
-    case 23:
-      _tap.DR<23, uint32_t>(out, &in);
-      break;
-    case 30:
-      _tap.DR<30, uint32_t>(out, &in);
-      break;
-    case 32:
-      _tap.DR<32, uint32_t>(out, &in);
-      break;
-    default:
-      break;
-  }
+  if (bits >= 1 && bits <= 32) _tap.DR(out, bits, &in);
   return in;
 }
 
+Vector<uint8_t> dr_bytes(Vector<uint8_t>& out, uint16_t bits) {
+  // Captured bits come back from the transfer buffer, no wider than out
+  const uint32_t limit = static_cast<uint32_t>(out.size) * 8;
+  if (bits > limit) bits = static_cast<uint16_t>(limit);
+  if (bits > sizeof(bulk::buffer) * 8) bits = sizeof(bulk::buffer) * 8;
+
+  if (bits) _tap.DR(&out[0], bulk::buffer, bits);
+  return Vector<uint8_t>((bits + 7) / 8, bulk::buffer, false);
+}
+
 void bypass() { _tap.bypass(); }
 uint32_t idcode() { return _tap.idcode(); }
 void idle_clocks(uint8_t count) { _tap.idle_clocks(count); }
 uint8_t codescan_read(uint16_t address) { return _tap.CODESCAN(address).data; }
 uint16_t read_idcode() { return _tap.IDCODE(); }
 
+void codescan_read_block(uint16_t address, uint16_t length) {
+  const uint32_t limit = 0x10000UL - address;
+  if (length > limit) length = static_cast<uint16_t>(limit);
+  const bool entered = length > 0;
+  if (entered && _session.jtag() != sinowealth::Status::OK) length = 0;
+
+  bulk::Writer frame(length);
+  _tap.CODESCAN.read(address, length, [&frame](uint8_t byte) { frame.put(byte); });
+  if (entered) _session.release();
+  frame.finish();
+  Serial.flush();
+}
+
+Vector<uint8_t> batch(Vector<uint8_t>& program) {
+  // Status byte first, then the captures, sent from the transfer buffer
+  uint16_t written = 0;
+  const auto status = scan::run(_tap, &program[0], program.size,
+                                bulk::buffer + 1, sizeof(bulk::buffer) - 1, written);
+  bulk::buffer[0] = static_cast<uint8_t>(status);
+  return Vector<uint8_t>(written + 1, bulk::buffer, false);
+}
+
 }  // namespace tap
 
 namespace icp {
@@ -118,53 +210,651 @@ bool verify() {
   return _icp.verify();
 }
 
-Vector<uint8_t> read(uint16_t address, size_t size) {
-  if (_phy.mode() != sinowealth::Phy::Mode::READY) { _phy.reset(); }
-  _phy.mode(sinowealth::Phy::Mode::ICP);
-  _icp.init();
+uint8_t calibrate() {
+  // Candidate half-period delay loops, fastest first
+  static constexpr uint8_t candidates[] = { 0, 1, 2, 3, 5, 8, 12, 20 };
+  static constexpr uint8_t readbacks = 8;
+
+  if (_phy.mode() == sinowealth::Phy::Mode::NOT_INITIALIZED) return 0xFF;
+
+  const uint8_t previous = config::Clock::loops;
+  uint8_t found = 0xFF;
+  for (uint8_t i = 0; i < sizeof(candidates) && found == 0xFF; ++i) {
+    config::Clock::loops = candidates[i];
+
+    // Re-enter ICP at the candidate rate, the mode byte is clocked too
+    _phy.reset();
+    _session.icp();
+
+    bool okay = true;
+    for (uint8_t n = 0; n < readbacks && okay; ++n) {
+      okay = _icp.verify();
+    }
+    if (okay) {
+      // One step of margin over the fastest passing rate
+      found = candidates[(i + 1 < sizeof(candidates)) ? i + 1 : i];
+    }
+  }
 
-  uint8_t* buffer = static_cast<uint8_t*>(malloc(size));
-  if (!buffer) return Vector<uint8_t>(0, nullptr, false);
-  _icp.read_flash(address, buffer, size);
+  config::Clock::loops = (found != 0xFF) ? found : previous;
   _phy.reset();
-  return Vector(size, buffer, true);
+  _session.release();
+  return found;
+}
+
+Vector<uint8_t> read(uint16_t address, size_t size) {
+  if (!_session.icp()) return Vector<uint8_t>(0, nullptr, false);
+
+  // Sent by simpleRPC after returning, the static buffer outlives the call
+  if (size > sizeof(bulk::buffer)) size = sizeof(bulk::buffer);
+  _icp.read_flash(address, bulk::buffer, size);
+  _session.release();
+  return Vector<uint8_t>(size, bulk::buffer, false);
+}
+
+void read_stream(uint16_t address, uint32_t length) {
+  // Flash address space ends at 64K, READ_FLASH does not wrap.
+  const uint32_t limit = 0x10000UL - address;
+  if (length > limit) length = limit;
+
+  if (!_session.icp()) return;
+
+  // Bytes go straight to the UART TX buffer, Serial.write() blocks when full
+  // which paces the ICP clock to the link.
+  _icp.begin_read(address);
+  for (uint32_t n = 0; n < length; ++n) {
+    Serial.write(_icp.receive_byte());
+  }
+  Serial.flush();
+  _session.release();
+}
+
+void bulk_read(uint16_t address, uint16_t length) {
+  const uint32_t limit = 0x10000UL - address;
+  if (length > limit) length = static_cast<uint16_t>(limit);
+  if (!_session.icp()) length = 0;
+
+  bulk::Writer frame(length);
+  if (length) {
+    _icp.begin_read(address);
+    for (uint16_t n = 0; n < length; ++n) {
+      frame.put(_icp.receive_byte());
+    }
+    _session.release();
+  }
+  frame.finish();
+  Serial.flush();
+}
+
+/** Program the first @p size bytes of bulk::buffer at address. */
+static bulk::Status program(uint16_t address, uint16_t size) {
+  if (!_session.icp()) return bulk::Status::ERR_TARGET;
+  const bool okay = _icp.write_flash(address, bulk::buffer, size, true);
+  _session.release();
+  return okay ? bulk::Status::OK : bulk::Status::ERR_TARGET;
+}
+
+void bulk_write(uint16_t address) {
+  uint16_t size;
+  auto status = bulk::receive(size);
+  if (status == bulk::Status::OK && size == 0) status = bulk::Status::ERR_SIZE;
+
+  if (status == bulk::Status::OK) status = program(address, size);
+
+  bulk::send_status(status);
+}
+
+/** First mismatch offset of write_verify when everything read back correctly. */
+static constexpr uint16_t VERIFY_OK = 0xFFFF;
+
+void write_verify(uint16_t address) {
+  uint16_t size;
+  auto status = bulk::receive(size);
+  if (status == bulk::Status::OK && size == 0) status = bulk::Status::ERR_SIZE;
+  if (status == bulk::Status::OK && !_session.icp()) status = bulk::Status::ERR_TARGET;
+
+  // Read back in the same session against the frame still in the buffer
+  uint16_t mismatch = VERIFY_OK;
+  if (status == bulk::Status::OK) {
+    _icp.write_flash(address, bulk::buffer, size, true);
+    _icp.begin_read(address);
+    for (uint16_t n = 0; n < size; ++n) {
+      if (_icp.receive_byte() != bulk::buffer[n]) {
+        mismatch = n;
+        break;
+      }
+    }
+    _session.release();
+    if (mismatch != VERIFY_OK) status = bulk::Status::ERR_TARGET;
+  }
+
+  const uint8_t reply[] = {static_cast<uint8_t>(status), static_cast<uint8_t>(mismatch),
+                           static_cast<uint8_t>(mismatch >> 8)};
+  bulk::send(reply, sizeof(reply));
+}
+
+static_assert(sizeof(bulk::buffer) >= sinowealth::ICP::SECTOR_SIZE,
+              "Sector transfers need a transfer buffer of at least one sector");
+
+void read_sector(uint16_t address) {
+  address &= ~(sinowealth::ICP::SECTOR_SIZE - 1);
+  uint16_t size = 0;
+  if (_session.icp()) {
+    size = sinowealth::ICP::SECTOR_SIZE;
+    _icp.read_flash(address, bulk::buffer, size);
+    _session.release();
+  }
+  bulk::send(bulk::buffer, size);
+}
+
+void write_sector(uint16_t address) {
+  address &= ~(sinowealth::ICP::SECTOR_SIZE - 1);
+  uint16_t size;
+  auto status = bulk::receive(size);
+  if (status == bulk::Status::OK && size != sinowealth::ICP::SECTOR_SIZE) {
+    status = bulk::Status::ERR_SIZE;
+  }
+
+  if (status == bulk::Status::OK) status = program(address, size);
+
+  bulk::send_status(status);
+}
+
+/** Programs sequential bytes as they arrive, ICP session already entered.
+ *
+ * Erased flash already reads 0xFF, so a long enough run of it ends the
+ * open write sequence and the next programmed byte restarts it. Sequences
+ * also end at sector boundaries.
+ */
+class Sequencer {
+ public:
+  explicit Sequencer(uint16_t address) : at_(address) {}
+
+  void put(uint8_t byte) {
+    if (writing_ && (at_ % sinowealth::ICP::SECTOR_SIZE) == 0) end();
+
+    if (byte == 0xFF) {
+      if (writing_ && ++blank_ == sinowealth::ICP::BLANK_RUN) end();
+    } else if (writing_) {
+      for (; blank_; --blank_) _icp.write_byte(0xFF);
+      _icp.write_byte(byte);
+    } else {
+      _icp.begin_write(at_, byte);
+      writing_ = true;
+    }
+    ++at_;
+  }
+
+  /** Leave count bytes erased. */
+  void skip(uint16_t count) {
+    static constexpr uint16_t sector = sinowealth::ICP::SECTOR_SIZE;
+    if (writing_ && (blank_ + count >= sinowealth::ICP::BLANK_RUN ||
+                     at_ % sector + count >= sector)) {
+      end();
+    }
+    if (writing_) blank_ += count;
+    at_ += count;
+  }
+
+  void finish() {
+    if (writing_) end();
+  }
+
+ private:
+  void end() {
+    _icp.end_write();
+    writing_ = false;
+    blank_ = 0;
+  }
+
+  uint16_t at_;
+  bool writing_ = false;
+  uint16_t blank_ = 0;  // 0xFF bytes held back from the open sequence
+};
+
+/**
+ * Erases and writes only reach main flash. The SET_EXTENDED operand that
+ * routes them to the custom block is unconfirmed, and a bad option byte
+ * write can lock a part, so block 1 is refused until it is. Reads select
+ * the custom block with READ_CUSTOM instead.
+ */
+static bool writable(uint8_t block) {
+  return block == static_cast<uint8_t>(sinowealth::ICP::Block::MAIN);
+}
+
+/** Program a credit-paced frame into main flash of a bank. */
+static void receive_stream(uint16_t address, uint8_t block, uint8_t bank) {
+  bulk::Reader frame;
+  if (!frame.begin()) {
+    bulk::send_status(bulk::Status::ERR_TIMEOUT);
+    return;
+  }
+
+  // A target failure still drains the frame so the link stays in sync
+  const uint16_t size = frame.length();
+  const bool program = size > 0 && writable(block) && _session.icp();
+  auto status = (program || size == 0) ? bulk::Status::OK : bulk::Status::ERR_TARGET;
+
+  if (program && bank) _icp.set_bank(bank);
+  Sequencer sequence(address);
+  for (uint16_t n = 0; n < size; ++n) {
+    uint8_t byte;
+    if (!frame.get(byte)) {
+      status = bulk::Status::ERR_TIMEOUT;
+      break;
+    }
+    // Free space is granted before programming, the UART refills meanwhile
+    if ((n + 1) % BULK_STREAM_CREDIT == 0) bulk::send_credit();
+    if (program) sequence.put(byte);
+  }
+  if (program) {
+    sequence.finish();
+    if (bank) _icp.set_bank(0);
+    _session.release();
+  }
+
+  if (status == bulk::Status::OK && !frame.finish()) {
+    status = bulk::Status::ERR_CHECKSUM;
+  }
+  bulk::send_status(status);
+}
+
+void write_stream(uint16_t address) { receive_stream(address, 0, 0); }
+
+void read_rle(uint16_t address, uint32_t length) {
+  const uint32_t limit = 0x10000UL - address;
+  if (length > limit) length = limit;
+  if (!_session.icp()) length = 0;
+
+  // Encoded on the fly into the transfer buffer, sent whenever the next
+  // byte might not fit. An empty frame ends the read.
+  rle::Encoder encoder(bulk::buffer);
+  if (length) _icp.begin_read(address);
+  for (uint32_t n = 0; n < length; ++n) {
+    encoder.put(_icp.receive_byte());
+    if (encoder.size() > sizeof(bulk::buffer) - 2 * rle::MAX_GROWTH) {
+      encoder.flush();
+      bulk::send(bulk::buffer, encoder.size());
+      encoder.reset();
+    }
+  }
+  if (length) _session.release();
+
+  encoder.flush();
+  if (encoder.size()) bulk::send(bulk::buffer, encoder.size());
+  bulk::send(bulk::buffer, 0);
+  Serial.flush();
+}
+
+void write_rle(uint16_t address) {
+  uint16_t size;
+  auto status = bulk::receive(size);
+  if (status == bulk::Status::OK && !_session.icp()) status = bulk::Status::ERR_TARGET;
+
+  if (status == bulk::Status::OK) {
+    Sequencer sequence(address);
+    const bool okay = rle::decode(
+        bulk::buffer, size,
+        [&](uint8_t byte) { sequence.put(byte); },
+        [&](uint8_t value, uint8_t count) {
+          if (value == 0xFF) {
+            sequence.skip(count);
+          } else {
+            while (count--) sequence.put(value);
+          }
+        });
+    sequence.finish();
+    _session.release();
+    if (!okay) status = bulk::Status::ERR_SIZE;
+  }
+
+  bulk::send_status(status);
+}
+
+/** Frame size of icp_read_image, READ_FLASH keeps counting across frames. */
+static constexpr uint16_t IMAGE_FRAME_SIZE = 0x4000;
+
+/** Stream a whole block from address 0, ICP session already entered. */
+static void send_block(sinowealth::ICP::Block block, uint32_t length) {
+  _icp.begin_read(0, block);
+  while (length) {
+    const uint16_t size = length < IMAGE_FRAME_SIZE ? length : IMAGE_FRAME_SIZE;
+    bulk::Writer frame(size);
+    for (uint16_t n = 0; n < size; ++n) {
+      frame.put(_icp.receive_byte());
+    }
+    frame.finish();
+    length -= size;
+  }
+}
+
+void read_image(uint32_t bank_size, uint8_t banks, uint16_t custom_size) {
+  if (bank_size > 0x10000UL) bank_size = 0x10000UL;
+
+  // Main flash bank by bank, then the custom block, ended by an empty frame
+  if (_session.icp()) {
+    for (uint8_t bank = 0; bank < banks; ++bank) {
+      if (banks > 1) _icp.set_bank(bank);
+      send_block(sinowealth::ICP::Block::MAIN, bank_size);
+    }
+    if (banks > 1) _icp.set_bank(0);
+    if (custom_size) send_block(sinowealth::ICP::Block::CUSTOM, custom_size);
+    _session.release();
+  }
+  bulk::send(bulk::buffer, 0);
+  Serial.flush();
+}
+
+void write_region(uint8_t block, uint8_t bank, uint16_t address) {
+  receive_stream(address, block, bank);
+}
+
+uint16_t erase_region(uint8_t block, uint8_t bank, uint16_t address) {
+  if (!writable(block) || !_session.icp()) return 0xFFFF;
+
+  uint16_t duration;
+  if (bank) _icp.set_bank(bank);
+  const bool okay = _icp.erase_flash(address, &duration);
+  if (bank) _icp.set_bank(0);
+  _session.release();
+  return okay ? duration : 0xFFFF;
+}
+
+/** CRC-32 of @p length bytes from address, ICP session already entered. */
+static uint32_t crc_flash(uint16_t address, uint32_t length) {
+  Crc32 crc;
+  _icp.begin_read(address);
+  for (uint32_t n = 0; n < length; ++n) {
+    crc.add(_icp.receive_byte());
+  }
+  return crc.value();
+}
+
+uint32_t crc(uint16_t address, uint32_t length) {
+  const uint32_t limit = 0x10000UL - address;
+  if (length > limit) length = limit;
+  if (!_session.icp()) return 0;
+
+  const uint32_t value = crc_flash(address, length);
+  _session.release();
+  return value;
+}
+
+Vector<uint32_t> crc_sectors(uint16_t address, uint8_t count) {
+  static constexpr uint16_t sector = sinowealth::ICP::SECTOR_SIZE;
+  // count is a u8, the results also have to fit the transfer buffer
+  static constexpr uint16_t fit = sizeof(bulk::buffer) / sizeof(uint32_t);
+  static constexpr uint8_t max_count = fit < 0xFF ? fit : 0xFF;
+  static_assert(max_count > 0 && max_count * sizeof(uint32_t) <= sizeof(bulk::buffer),
+                "Sector CRCs must fit the transfer buffer");
+
+  address &= ~(sector - 1);
+  const uint8_t remaining = static_cast<uint8_t>((0x10000UL - address) / sector);
+  if (count > remaining) count = remaining;
+  if (count > max_count) count = max_count;
+  if (!_session.icp()) return Vector<uint32_t>(0, nullptr, false);
+
+  // Results live in the transfer buffer until simpleRPC has sent them
+  auto* crcs = reinterpret_cast<uint32_t*>(bulk::buffer);
+  for (uint8_t n = 0; n < count; ++n) {
+    crcs[n] = crc_flash(address + n * sector, sector);
+  }
+  _session.release();
+  return Vector<uint32_t>(count, crcs, false);
+}
+
+bool blank_check(uint16_t address, uint32_t length) {
+  const uint32_t limit = 0x10000UL - address;
+  if (length > limit) length = limit;
+  if (!_session.icp()) return false;
+
+  const bool blank = _icp.blank_check(address, length);
+  _session.release();
+  return blank;
 }
 
 bool erase(uint16_t address) {
-  if (_phy.mode() != sinowealth::Phy::Mode::READY) { _phy.reset(); }
-  _phy.mode(sinowealth::Phy::Mode::ICP);
-  _icp.init();
+  if (!_session.icp()) return false;
 
   bool okay = _icp.erase_flash(address);
-  _phy.reset();
+  _session.release();
   return okay;
 }
 
+uint16_t erase_timed(uint16_t address) {
+  if (!_session.icp()) return 0xFFFF;
+
+  uint16_t duration;
+  const bool okay = _icp.erase_flash(address, &duration);
+  _session.release();
+  return okay ? duration : 0xFFFF;
+}
+
+Vector<uint16_t> erase_range(uint16_t address, uint8_t count) {
+  static constexpr uint16_t sector = sinowealth::ICP::SECTOR_SIZE;
+
+  address &= ~(sector - 1);
+  const uint8_t remaining = static_cast<uint8_t>((0x10000UL - address) / sector);
+  if (count > remaining) count = remaining;
+  if (!_session.icp()) return Vector<uint16_t>(0, nullptr, false);
+
+  // Stops after the first failing sector, which is reported as 0xFFFF
+  auto* durations = reinterpret_cast<uint16_t*>(bulk::buffer);
+  uint8_t n = 0;
+  while (n < count) {
+    uint16_t duration;
+    const bool okay = _icp.erase_flash(address + n * sector, &duration);
+    durations[n++] = okay ? duration : 0xFFFF;
+    if (!okay) break;
+  }
+  _session.release();
+  return Vector<uint16_t>(n, durations, false);
+}
+
 bool write(uint16_t address, Vector<uint8_t>& buffer) {
-  if (_phy.mode() != sinowealth::Phy::Mode::READY) { _phy.reset(); }
-  _phy.mode(sinowealth::Phy::Mode::ICP);
-  _icp.init();
+  if (!_session.icp()) return false;
 
-  bool okay = _icp.write_flash(address, &buffer[0], buffer.size);
-  _phy.reset();
+  bool okay = _icp.write_flash(address, &buffer[0], buffer.size, true);
+  _session.release();
   return okay;
 }
 
 }  // namespace icp
 
+#if SINOJTAG_GANG
+extern gang::Phy _gang_phy;
+extern gang::ICP _gang_icp;
+
+namespace gang_icp {
+
+/** Enter ICP on every site from READY. @return PHY is initialized. */
+static bool enter() {
+  if (_gang_phy.mode() == sinowealth::Phy::Mode::NOT_INITIALIZED) return false;
+  _gang_phy.reset();
+  _gang_phy.mode(sinowealth::Phy::Mode::ICP);
+  _gang_icp.init();
+  return true;
+}
+
+void init() { _gang_phy.init(); }
+
+void stop() { _gang_phy.stop(); }
+
+uint8_t sites() { return gang::SITES; }
+
+uint8_t verify() {
+  if (!enter()) return 0;
+  const uint8_t okay = _gang_icp.verify();
+  _gang_phy.reset();
+  return okay;
+}
+
+uint8_t erase(uint16_t address) {
+  if (!enter()) return 0;
+  const uint8_t okay = _gang_icp.erase_flash(address);
+  _gang_phy.reset();
+  return okay;
+}
+
+void bulk_write(uint16_t address) {
+  uint16_t size;
+  auto status = bulk::receive(size);
+  if (status == bulk::Status::OK && size == 0) status = bulk::Status::ERR_SIZE;
+
+  if (status == bulk::Status::OK) {
+    if (enter()) {
+      _gang_icp.write_flash(address, bulk::buffer, size);
+      _gang_phy.reset();
+    } else {
+      status = bulk::Status::ERR_TARGET;
+    }
+  }
+  bulk::send_status(status);
+}
+
+Vector<uint32_t> crc(uint16_t address, uint32_t length) {
+  const uint32_t limit = 0x10000UL - address;
+  if (length > limit) length = limit;
+  if (!enter()) return Vector<uint32_t>(0, nullptr, false);
+
+  // One pass reads every site, each keeps its own CRC
+  Crc32 crcs[gang::SITES];
+  uint8_t bytes[gang::SITES];
+  _gang_icp.begin_read(address);
+  for (uint32_t n = 0; n < length; ++n) {
+    _gang_icp.receive_byte(bytes);
+    for (uint8_t site = 0; site < gang::SITES; ++site) crcs[site].add(bytes[site]);
+  }
+  _gang_phy.reset();
+
+  auto* values = reinterpret_cast<uint32_t*>(bulk::buffer);
+  for (uint8_t site = 0; site < gang::SITES; ++site) values[site] = crcs[site].value();
+  return Vector<uint32_t>(gang::SITES, values, false);
+}
+
+}  // namespace gang_icp
+#endif  // SINOJTAG_GANG
+
+#if SINOJTAG_PROFILE
+namespace stats {
+
+/** F_CPU, then cycles and calls per profile::Phase. */
+Vector<uint32_t> get() {
+  constexpr uint8_t phases = static_cast<uint8_t>(profile::Phase::COUNT);
+  static_assert((1 + 2 * phases) * sizeof(uint32_t) <= BULK_BUFFER_SIZE,
+                "Profile counters must fit the transfer buffer");
+
+  auto* values = reinterpret_cast<uint32_t*>(bulk::buffer);
+  values[0] = F_CPU;
+  for (uint8_t n = 0; n < phases; ++n) {
+    const auto& c = profile::counter(static_cast<profile::Phase>(n));
+    values[1 + 2 * n] = c.cycles;
+    values[2 + 2 * n] = c.calls;
+  }
+  return Vector<uint32_t>(1 + 2 * phases, values, false);
+}
+
+void reset() { profile::reset(); }
+
+}  // namespace stats
+#endif  // SINOJTAG_PROFILE
+
+#if SINOJTAG_BENCH
+namespace bench {
+
+// With shift set every byte also goes through the ICP shifter. That is
+// only allowed with the PHY uninitialized, so the pins are inputs and no
+// target sees the clocks: a dummy load that costs the same cycles.
+
+/**
+ * Shifter PORT writes to input pins would switch their pull-ups at clock
+ * rate, so run with pull-ups disabled globally and clear the port bits the
+ * shifter left set before enabling them again.
+ */
+class Detached {
+ public:
+  Detached() { MCUCR |= _BV(PUD); }
+  ~Detached() {
+    _phy.stop();
+    MCUCR &= static_cast<uint8_t>(~_BV(PUD));
+  }
+};
+
+/** Bulk frame of length bytes without touching a target. */
+void read(uint16_t length, bool shift) {
+  if (shift && _phy.mode() != sinowealth::Phy::Mode::NOT_INITIALIZED) length = 0;
+
+  bulk::Writer frame(length);
+  if (shift) {
+    Detached detached;
+    for (uint16_t n = 0; n < length; ++n) frame.put(_icp.receive_byte());
+  } else {
+    for (uint16_t n = 0; n < length; ++n) frame.put(static_cast<uint8_t>(n));
+  }
+  frame.finish();
+}
+
+/** Receive a bulk frame and discard it, answered by a status byte. */
+void write(bool shift) {
+  uint16_t size;
+  auto status = bulk::receive(size);
+  if (status == bulk::Status::OK && shift) {
+    if (_phy.mode() != sinowealth::Phy::Mode::NOT_INITIALIZED) {
+      status = bulk::Status::ERR_TARGET;
+    } else {
+      Detached detached;
+      for (uint16_t n = 0; n < size; ++n) _icp.send_byte(bulk::buffer[n]);
+    }
+  }
+  bulk::send_status(status);
+}
+
+}  // namespace bench
+#endif  // SINOJTAG_BENCH
+
 namespace rpc {
 
-void setup() { Serial.begin(UART_BAUD); }
+void setup() {
+  headroom::paint();
+  Serial.begin(UART_BAUD);
+  profile::init();
+}
 
 void loop() {
+  bulk::poll();
+  // Only passes that dispatch a call count towards RPC
+  if (!Serial.available()) return;
+  profile::Scope scope(profile::Phase::RPC);
   interface(
       Serial,
       phy::init,
         F("phy_init: Initialize SinoWealth diagnostics mode."),
+      phy::attach,
+        F("phy_attach: Attach to a target already in diagnostic mode, running the entry waveform only if it doesn't answer. @return: Attached without the entry waveform"),
       phy::reset,
         F("phy_reset: Reset PHY to READY state. @return: Okay"),
       phy::stop,
         F("phy_stop: Sets JTAG ping to Hi-Z, will require target power cycle to use JTAG again."),
+      phy::set_clock,
+        F("phy_set_clock: Set TCK half-period. @loops: 3-cycle delay loops, 0 = fastest."),
+      phy::get_clock,
+        F("phy_get_clock: Get TCK half-period. @return: 3-cycle delay loops."),
+      phy::set_timing,
+        F("phy_set_timing: Select the waveform timing profile, verified via ICP readback once initialized. @profile: 0 = conservative, 1 = fast. @return: Okay, false falls back to conservative"),
+      phy::get_timing,
+        F("phy_get_timing: Get the waveform timing profile. @return: Profile"),
+      link::set_baud,
+        F("link_set_baud: Switch UART baud rate after this response. @baud: 115200, 250000, 500000, 1000000 or 2000000 (not with timer TCK). @return: Okay"),
+      link::buffer_capacity,
+        F("buffer_capacity: Size of the static transfer buffer. @return: Bytes"),
+      link::headroom,
+        F("link_headroom: Smallest free RAM between heap and stack since boot. @return: Bytes"),
+      session::open,
+        F("session_open: Keep the active mode between calls until session_close. @return: Okay"),
+      session::close,
+        F("session_close: End the session and reset PHY to READY state."),
+      session::run_pipeline,
+        F("pipeline_run: Execute tagged request frames sent after the call until END, see pipeline.h."),
       tap::init,
         F("tap_init: Initialize JTAG interface. @return: Status (0=OK)."),
       tap::state,
@@ -176,7 +866,9 @@ void loop() {
       tap::ir,
         F("tap_ir: Shift instruction register. @out: Value. @return: Captured."),
       tap::dr,
-        F("tap_dr: Shift data register. @out: Value. @bits: Width. @return: Captured."),
+        F("tap_dr: Shift data register. @out: Value. @bits: Width, 1 to 32. @return: Captured."),
+      tap::dr_bytes,
+        F("tap_dr_bytes: Shift a data register of any width. @out: Value bytes, LSB first. @bits: Width, at most 8 per byte of out. @return: Captured bytes, LSB first."),
       tap::bypass,
         F("tap_bypass: Select BYPASS register."),
       tap::idcode,
@@ -187,16 +879,84 @@ void loop() {
         F("icp_init: Initialize ICP interface."),
       icp::verify,
         F("icp_verify: Perform readback test on ICP. @return: Okay"),
+      icp::calibrate,
+        F("icp_calibrate: Find fastest reliable TCK rate via ICP readback and apply it. @return: Delay loops (255 = no rate passed)."),
       icp::read,
-        F("icp_read: Read flash memory via ICP. @address: 16-bit address. @size: 8-bit read length. @return: Data"),
+        F("icp_read: Read flash memory via ICP. @address: 16-bit address. @size: Read length, at most buffer_capacity. @return: Data"),
+      icp::read_stream,
+        F("icp_read_stream: Stream flash memory via ICP as raw bytes following the call. @address: 16-bit address. @length: Number of bytes, clamped to end of flash."),
+      icp::bulk_read,
+        F("icp_bulk_read: Read flash memory via ICP as a bulk frame following the call. @address: 16-bit address. @length: Number of bytes, clamped to end of flash."),
+      icp::bulk_write,
+        F("icp_bulk_write: Write a bulk frame sent after the call to previously erased flash, answered by a status byte. @address: 16-bit address."),
+      icp::write_verify,
+        F("icp_write_verify: Program a bulk frame sent after the call to previously erased flash and read it back in the same session, answered by a frame of a status byte and the u16 offset of the first mismatch (65535 = none). @address: 16-bit address."),
+      icp::read_sector,
+        F("icp_read_sector: Read a 1K flash sector via ICP as a bulk frame following the call. @address: 16-bit address within the sector."),
+      icp::write_sector,
+        F("icp_write_sector: Write a 1K bulk frame sent after the call to a previously erased sector, answered by a status byte. @address: 16-bit address within the sector."),
+      icp::write_stream,
+        F("icp_write_stream: Program a credit-paced bulk frame sent after the call to previously erased flash, answered by a status byte. @address: 16-bit address."),
+      icp::read_rle,
+        F("icp_read_rle: Read flash as run-length encoded bulk frames following the call, ended by an empty frame. @address: 16-bit address. @length: Number of bytes (32-bit), clamped to end of flash."),
+      icp::write_rle,
+        F("icp_write_rle: Program a run-length encoded bulk frame sent after the call to previously erased flash, answered by a status byte. @address: 16-bit address."),
+      icp::read_image,
+        F("icp_read_image: Read main flash bank by bank then the custom block as bulk frames following the call, ended by an empty frame. @bank_size: Bytes per XPAGE bank (32-bit), at most 64K. @banks: Number of banks. @custom_size: Custom block bytes, 0 to skip."),
+      icp::write_region,
+        F("icp_write_region: Program a credit-paced bulk frame sent after the call into a block and bank, answered by a status byte. @block: 0 = main flash, 1 (custom block) is refused. @bank: XPAGE bank. @address: 16-bit address."),
+      icp::erase_region,
+        F("icp_erase_region: Erase a sector of a block and bank. @block: 0 = main flash, 1 (custom block) is refused. @bank: XPAGE bank. @address: 16-bit address. @return: Erase time in ms (65535 = failed or refused)"),
+      icp::crc,
+        F("icp_crc: CRC-32 (zlib) of a flash range read via ICP. @address: 16-bit address. @length: Number of bytes, clamped to end of flash. @return: CRC-32"),
+      icp::crc_sectors,
+        F("icp_crc_sectors: CRC-32 (zlib) of each 1K sector from address. @address: 16-bit address within the first sector. @count: Number of sectors. @return: CRC-32 per sector"),
+      icp::blank_check,
+        F("icp_blank_check: Check a flash range reads all 0xFF, stops at the first byte that doesn't. @address: 16-bit address. @length: Number of bytes, clamped to end of flash. @return: Blank"),
       icp::erase,
         F("icp_erase: Erase a sector of flash memory. @address: 16-bit address. @return: Okay"),
+      icp::erase_timed,
+        F("icp_erase_timed: Erase a sector of flash memory. @address: 16-bit address. @return: Erase time in ms (65535 = failed)"),
+      icp::erase_range,
+        F("icp_erase_range: Erase consecutive sectors in one session, stops at the first failure. @address: 16-bit address within the first sector. @count: Number of sectors. @return: Erase time in ms per sector (65535 = failed)"),
       icp::write,
         F("icp_write: Write data to previously erase sector. @address: 16-bit address. @buffer: Data to write. @return: Okay"),
       tap::codescan_read,
         F("tap_codescan_read: Read flash byte via CODESCAN. @address: 16-bit address. @return: Data byte."),
       tap::read_idcode,
-        F("tap_read_idcode: Read 16-bit IDCODE. @return: 16-bit ID.")
+        F("tap_read_idcode: Read 16-bit IDCODE. @return: 16-bit ID."),
+      tap::codescan_read_block,
+        F("tap_codescan_read_block: Read flash via pipelined CODESCAN as a bulk frame following the call. @address: 16-bit address. @length: Number of bytes, clamped to end of flash."),
+      tap::batch,
+        F("tap_batch: Run a scan program in one call. @program: Scan ops, see scan.h. @return: Status byte (0=OK) followed by captured values.")
+#if SINOJTAG_GANG
+      , gang_icp::init,
+        F("gang_init: Initialize SinoWealth diagnostics mode on every gang site."),
+      gang_icp::stop,
+        F("gang_stop: Sets gang pins to Hi-Z."),
+      gang_icp::sites,
+        F("gang_sites: Number of gang sites. @return: Sites"),
+      gang_icp::verify,
+        F("gang_verify: Perform readback test on every site. @return: Mask of sites that passed"),
+      gang_icp::erase,
+        F("gang_erase: Erase a sector of flash memory on every site. @address: 16-bit address. @return: Mask of sites that reported success"),
+      gang_icp::bulk_write,
+        F("gang_bulk_write: Write a bulk frame sent after the call to previously erased flash on every site, answered by a status byte. @address: 16-bit address."),
+      gang_icp::crc,
+        F("gang_crc: CRC-32 (zlib) of a flash range on every site. @address: 16-bit address. @length: Number of bytes, clamped to end of flash. @return: CRC-32 per site")
+#endif
+#if SINOJTAG_PROFILE
+      , stats::get,
+        F("stats_get: Profile counters since start or stats_reset. @return: F_CPU, then cycles and calls per phase"),
+      stats::reset,
+        F("stats_reset: Zero the profile counters.")
+#endif
+#if SINOJTAG_BENCH
+      , bench::read,
+        F("bench_read: Send a synthetic bulk frame following the call. @length: Payload bytes. @shift: Clock every byte through the ICP shifter, needs the PHY uninitialized."),
+      bench::write,
+        F("bench_write: Receive and discard a bulk frame sent after the call, answered by a status byte. @shift: Clock every byte through the ICP shifter, needs the PHY uninitialized.")
+#endif
   );
 }
 
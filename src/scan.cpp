@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "scan.h"
+
+namespace {
+  /** Bounds-checked cursor over the program and result buffers. */
+  class Cursor {
+   public:
+    Cursor(const uint8_t* program, uint16_t size, uint8_t* out, uint16_t capacity)
+        : program_(program), size_(size), out_(out), capacity_(capacity) {}
+
+    bool done() const { return pc_ >= size_; }
+
+    /** Read a little-endian operand of the given width. */
+    bool read(uint8_t bytes, uint32_t& value) {
+      if (size_ - pc_ < bytes) return false;
+      value = 0;
+      for (uint8_t n = 0; n < bytes; ++n) {
+        value |= static_cast<uint32_t>(program_[pc_++]) << (8 * n);
+      }
+      return true;
+    }
+
+    /** Append a little-endian result of the given width. */
+    bool write(uint8_t bytes, uint32_t value) {
+      if (capacity_ - written_ < bytes) return false;
+      for (uint8_t n = 0; n < bytes; ++n) {
+        out_[written_++] = static_cast<uint8_t>(value >> (8 * n));
+      }
+      return true;
+    }
+
+    uint16_t written() const { return written_; }
+
+   private:
+    const uint8_t* program_;
+    uint16_t size_;
+    uint16_t pc_ = 0;
+    uint8_t* out_;
+    uint16_t capacity_;
+    uint16_t written_ = 0;
+  };
+
+  using scan::Status;
+
+  Status step(sinowealth::Tap& tap, Cursor& cursor) {
+    uint32_t op;
+    uint32_t arg;
+    cursor.read(1, op);
+    const bool capture = op & scan::CAPTURE;
+
+    switch (op & ~scan::CAPTURE) {
+      case scan::RESET:
+        tap.reset();
+        return Status::OK;
+
+      case scan::GOTO:
+        if (!cursor.read(1, arg)) return Status::ERR_TRUNCATED;
+        if (arg > 15) return Status::ERR_OPCODE;
+        tap.goto_state(static_cast<SimpleJTAG::Tap::State>(arg));
+        return Status::OK;
+
+      case scan::IDLE:
+        if (!cursor.read(1, arg)) return Status::ERR_TRUNCATED;
+        tap.idle_clocks(static_cast<uint8_t>(arg));
+        return Status::OK;
+
+      case scan::IR: {
+        if (!cursor.read(1, arg)) return Status::ERR_TRUNCATED;
+        uint8_t in = 0;
+        tap.IR(static_cast<uint8_t>(arg), &in);
+        if (capture && !cursor.write(1, in)) return Status::ERR_OVERFLOW;
+        return Status::OK;
+      }
+
+      case scan::DR: {
+        uint32_t bits;
+        if (!cursor.read(1, bits)) return Status::ERR_TRUNCATED;
+        if (bits == 0 || bits > 32) return Status::ERR_OPCODE;
+        const uint8_t bytes = static_cast<uint8_t>((bits + 7) / 8);
+        if (!cursor.read(bytes, arg)) return Status::ERR_TRUNCATED;
+        uint32_t in = 0;
+        tap.DR(arg, static_cast<uint8_t>(bits), &in);
+        if (capture && !cursor.write(bytes, in)) return Status::ERR_OVERFLOW;
+        return Status::OK;
+      }
+
+      case scan::CODESCAN:
+        if (!cursor.read(2, arg)) return Status::ERR_TRUNCATED;
+        if (!cursor.write(1, tap.CODESCAN(static_cast<uint16_t>(arg)).data)) {
+          return Status::ERR_OVERFLOW;
+        }
+        return Status::OK;
+
+      default:
+        return Status::ERR_OPCODE;
+    }
+  }
+}  // namespace
+
+namespace scan {
+
+Status run(sinowealth::Tap& tap, const uint8_t* program, uint16_t size,
+           uint8_t* out, uint16_t capacity, uint16_t& written) {
+  Cursor cursor(program, size, out, capacity);
+  Status status = Status::OK;
+  while (status == Status::OK && !cursor.done()) {
+    status = step(tap, cursor);
+  }
+  written = cursor.written();
+  return status;
+}
+
+}  // namespace scan
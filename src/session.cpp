@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Michael "ASAP" Weinrich
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "session.h"
+
+#include <Arduino.h>
+
+using Mode = sinowealth::Phy::Mode;
+
+bool Session::open() {
+  if (phy_.mode() == Mode::NOT_INITIALIZED) return false;
+  held_ = true;
+  touch();
+  return true;
+}
+
+void Session::close() {
+  held_ = false;
+  linked_ = false;
+  phy_.reset();
+}
+
+bool Session::icp() {
+  if (phy_.mode() == Mode::NOT_INITIALIZED) return false;
+
+  if (held_ && linked(Mode::ICP)) {
+    if (!expired()) {
+      touch();
+      return true;
+    }
+    // Idle too long, make sure the target is still listening
+    icp_.ping();
+    if (icp_.verify()) {
+      touch();
+      return true;
+    }
+  }
+
+  if (phy_.mode() != Mode::READY) { phy_.reset(); }
+  phy_.mode(Mode::ICP);
+  icp_.init();
+  linked_ = true;
+  touch();
+  return true;
+}
+
+sinowealth::Status Session::jtag() {
+  if (held_ && linked(Mode::JTAG) && jtag_status_ == sinowealth::Status::OK) {
+    if (!expired()) {
+      touch();
+      return jtag_status_;
+    }
+    // Idle too long, a readable IDCODE means the TAP is still up
+    const uint16_t id = tap_.IDCODE();
+    if (id != 0x0000 && id != 0xFFFF) {
+      touch();
+      return jtag_status_;
+    }
+  }
+
+  phy_.mode(Mode::JTAG);
+  tap_.invalidate_ir();
+  jtag_status_ = tap_.init();
+  linked_ = true;
+  touch();
+  return jtag_status_;
+}
+
+void Session::release() {
+  if (held_) {
+    touch();
+    return;
+  }
+  linked_ = false;
+  phy_.reset();
+}
+
+bool Session::expired() const {
+  return (millis() - last_ms_) >= SESSION_TIMEOUT_MS;
+}
+
+void Session::touch() { last_ms_ = millis(); }
@@ -24,8 +24,18 @@
 #include <util/delay.h>
 #include <SimpleJTAG/phy.h>
 
+#include "profile.h"
 #include "sinowealth/phy.h"
 #include "sinowealth/icp.h"
+#include "sinowealth/sequence.h"
+
+#ifndef SINOWEALTH_ICP_FAST_SHIFT
+#define SINOWEALTH_ICP_FAST_SHIFT 0
+#endif
+
+#ifndef SINOWEALTH_ICP_FAST_HALF
+#define SINOWEALTH_ICP_FAST_HALF 4
+#endif
 
 namespace {
   /** Flip the bits of a uint8_t */
@@ -43,29 +53,133 @@ namespace {
     v = ((v >> 1) & 0x5555) | ((v << 1) & 0xAAAA);
     return v;
   }
+
+#if SINOWEALTH_ICP_FAST_SHIFT
+  /* Unrolled ICP byte kernels.
+   *
+   * Fixed cycle timing independent of the TCK clock policy: every bit costs
+   * the same number of cycles whatever its value, and TCK is toggled with a
+   * single PIND write. Each half-period is padded with
+   * SINOWEALTH_ICP_FAST_HALF nops. Like the generic path a byte is 8 data
+   * clocks plus 1 trailing clock with TMS held low.
+   */
+  using namespace config;
+  static_assert(tck::port_letter == 'D' && tms::port_letter == 'D' &&
+                tdi::port_letter == 'D' && tdo::port_letter == 'D',
+                "ICP fast shift requires TCK/TMS/TDI/TDO on PORTD");
+
+  #define ICP_HALF ".rept %[half]\n\tnop\n\t.endr\n\t"
+
+  // TDI from bit n (2+3 cycles either way), then one full TCK pulse
+  #define ICP_TX_BIT(n)               \
+    "sbrc %[v], " #n "\n\t"           \
+    "sbi %[port], %[tdi]\n\t"         \
+    "sbrs %[v], " #n "\n\t"           \
+    "cbi %[port], %[tdi]\n\t"         \
+    ICP_HALF                          \
+    "out %[pin], %[tck]\n\t"          \
+    ICP_HALF                          \
+    "out %[pin], %[tck]\n\t"
+
+  // TCK pulse, TDO sampled into bit n before the falling edge (2 cycles)
+  #define ICP_RX_BIT(n)               \
+    ICP_HALF                          \
+    "out %[pin], %[tck]\n\t"          \
+    ICP_HALF                          \
+    "sbic %[pin], %[tdo]\n\t"         \
+    "ori %[v], 1<<" #n "\n\t"         \
+    "out %[pin], %[tck]\n\t"
+
+  // Trailing clock after each byte
+  #define ICP_TRAIL                   \
+    ICP_HALF                          \
+    "out %[pin], %[tck]\n\t"          \
+    ICP_HALF                          \
+    "out %[pin], %[tck]\n\t"
+
+  /** Shift a byte out MSb-first. @pre TCK low. */
+  inline void fast_send_byte(uint8_t byte) {
+    asm volatile(
+      "cbi %[port], %[tms]\n\t"
+      ICP_TX_BIT(7) ICP_TX_BIT(6) ICP_TX_BIT(5) ICP_TX_BIT(4)
+      ICP_TX_BIT(3) ICP_TX_BIT(2) ICP_TX_BIT(1) ICP_TX_BIT(0)
+      "cbi %[port], %[tdi]\n\t"
+      ICP_TRAIL
+      :
+      : [v] "r" (byte),
+        [tck] "r" (static_cast<uint8_t>(_BV(tck::index))),
+        [port] "I" (_SFR_IO_ADDR(PORTD)),
+        [pin] "I" (_SFR_IO_ADDR(PIND)),
+        [tms] "I" (tms::index),
+        [tdi] "I" (tdi::index),
+        [half] "n" (SINOWEALTH_ICP_FAST_HALF)
+    );
+  }
+
+  /** Shift a byte in LSb-first with TDI low. @pre TCK low. */
+  inline uint8_t fast_receive_byte() {
+    uint8_t byte = 0;
+    asm volatile(
+      "cbi %[port], %[tms]\n\t"
+      "cbi %[port], %[tdi]\n\t"
+      ICP_RX_BIT(0) ICP_RX_BIT(1) ICP_RX_BIT(2) ICP_RX_BIT(3)
+      ICP_RX_BIT(4) ICP_RX_BIT(5) ICP_RX_BIT(6) ICP_RX_BIT(7)
+      ICP_TRAIL
+      : [v] "+d" (byte)
+      : [tck] "r" (static_cast<uint8_t>(_BV(tck::index))),
+        [port] "I" (_SFR_IO_ADDR(PORTD)),
+        [pin] "I" (_SFR_IO_ADDR(PIND)),
+        [tms] "I" (tms::index),
+        [tdi] "I" (tdi::index),
+        [tdo] "I" (tdo::index),
+        [half] "n" (SINOWEALTH_ICP_FAST_HALF)
+    );
+    return byte;
+  }
+
+  #undef ICP_TRAIL
+  #undef ICP_RX_BIT
+  #undef ICP_TX_BIT
+  #undef ICP_HALF
+#endif
 }
 
 namespace sinowealth {
 
 void ICP::init() {
-  _delay_us(800);       // TODO: Verify length of delay
+  profile::Scope scope(profile::Phase::ICP_INIT);
+  timing::dispatch([this](auto t) { init<decltype(t)>(); });
+}
+
+template <typename Timing>
+void ICP::init() {
+  _delay_us(Timing::ICP_INIT_US);
   ping();
 }
 
 void ICP::send_byte(uint8_t byte) {
+#if SINOWEALTH_ICP_FAST_SHIFT
+  fast_send_byte(byte);
+#else
   // bytes go out MSb-first
   byte = bit_reverse(byte);
   Phy::stream_bits<8, false>(byte);
   Phy::next_state(false);   // 1 extra clock pulse
+#endif
 }
 
 
 uint8_t ICP::receive_byte() {
+  profile::Scope scope(profile::Phase::ICP_READ);
+#if SINOWEALTH_ICP_FAST_SHIFT
+  return fast_receive_byte();
+#else
   // and come back LSb-first
   uint8_t byte = 0;
   Phy::stream_bits<8, false, uint8_t>(0, &byte);
   Phy::next_state(false);
   return byte;
+#endif
 }
 
 void ICP::ping() {
@@ -90,48 +204,80 @@ void ICP::set_address(uint16_t address) {
   send_byte(static_cast<uint8_t>((address >> 8) & 0xFF));
 }
 
-void ICP::read_flash(uint16_t address, uint8_t* buffer, size_t size) {
+void ICP::set_bank(uint8_t bank) {
+  send_byte(CommandSet::SET_XPAGE);
+  send_byte(bank);
+}
+
+void ICP::begin_read(uint16_t address, Block block) {
   set_address(address);
-  // TODO: Support custom block
-  send_byte(CommandSet::READ_FLASH);
+  send_byte(block == Block::CUSTOM ? CommandSet::READ_CUSTOM : CommandSet::READ_FLASH);
+}
+
+void ICP::read_flash(uint16_t address, uint8_t* buffer, size_t size) {
+  begin_read(address);
 
   for (size_t n = 0; n < size; ++n) {
     buffer[n] = receive_byte();
   }
 }
 
-bool ICP::write_flash(uint16_t address, const uint8_t* buffer, size_t size) {
-  if (size == 0) {
-    return false;
-  }
-  set_address(address);
+void ICP::begin_write(uint16_t address, uint8_t first) {
+  sequence::begin_write(*this, address, first);
+}
 
-  send_byte(CommandSet::SET_IB_DATA);
-  send_byte(buffer[0]);
+void ICP::write_byte(uint8_t byte) {
+  timing::dispatch([this, byte](auto t) { write_byte<decltype(t)>(byte); });
+}
 
-  // Write unlock sequence
-  send_byte(CommandSet::WRITE_UNLOCK);
-  for (auto b : CommandSet::PREAMBLE) {
-    send_byte(b);
-  }
+template <typename Timing>
+void ICP::write_byte(uint8_t byte) {
+  sequence::write_byte<Timing>(*this, byte);
+}
 
-  // Remaining data bytes with inter-byte delay
-  for (size_t n = 1; n < size; ++n) {
-    send_byte(buffer[n]);
-    _delay_us(5);
-    send_byte(0x00);
-  }
+void ICP::end_write() {
+  timing::dispatch([this](auto t) { end_write<decltype(t)>(); });
+}
 
-  // Write termination sequence
-  for (auto b : CommandSet::WRITE_TERM) {
-    send_byte(b);
-  }
-  _delay_us(5);
+template <typename Timing>
+void ICP::end_write() {
+  sequence::end_write<Timing>(*this);
+}
 
+bool ICP::write_flash(uint16_t address, const uint8_t* buffer, uint16_t size,
+                      bool skip_blank) {
+  profile::Scope scope(profile::Phase::ICP_WRITE);
+  return timing::dispatch([&](auto t) {
+    return write_flash<decltype(t)>(address, buffer, size, skip_blank);
+  });
+}
+
+template <typename Timing>
+bool ICP::write_flash(uint16_t address, const uint8_t* buffer, uint16_t size,
+                      bool skip_blank) {
+  return sequence::write<Timing>(*this, address, buffer, size, skip_blank);
+}
+
+bool ICP::blank_check(uint16_t address, uint32_t length) {
+  begin_read(address);
+
+  for (uint32_t n = 0; n < length; ++n) {
+    if (receive_byte() != 0xFF) {
+      return false;
+    }
+  }
   return true;
 }
 
-bool ICP::erase_flash(uint16_t address) {
+bool ICP::erase_flash(uint16_t address, uint16_t* duration_ms) {
+  profile::Scope scope(profile::Phase::ICP_ERASE);
+  return timing::dispatch([&](auto t) {
+    return erase_flash<decltype(t)>(address, duration_ms);
+  });
+}
+
+template <typename Timing>
+bool ICP::erase_flash(uint16_t address, uint16_t* duration_ms) {
   set_address(address);
 
   send_byte(CommandSet::SET_IB_DATA);
@@ -144,12 +290,28 @@ bool ICP::erase_flash(uint16_t address) {
   }
 
   send_byte(0x00);
-  _delay_ms(300);
+  const uint16_t elapsed = sequence::wait_erase<Timing>(
+      []() -> uint8_t { return Phy::read_pin(config::tdo::pin, config::tdo::index); }, 1);
   send_byte(0x00);
   bool status = Phy::read_pin(config::tdo::pin, config::tdo::index);
   send_byte(0x00);
 
+  if (duration_ms) {
+    *duration_ms = elapsed;
+  }
   return status;
 }
 
+#define SINOWEALTH_ICP_TIMING(T)                                              \
+  template void ICP::init<T>();                                               \
+  template void ICP::write_byte<T>(uint8_t);                                  \
+  template void ICP::end_write<T>();                                          \
+  template bool ICP::write_flash<T>(uint16_t, const uint8_t*, uint16_t, bool); \
+  template bool ICP::erase_flash<T>(uint16_t, uint16_t*);
+
+SINOWEALTH_ICP_TIMING(timing::Conservative)
+SINOWEALTH_ICP_TIMING(timing::Fast)
+
+#undef SINOWEALTH_ICP_TIMING
+
 }  // namespace sinowealth
@@ -20,7 +20,9 @@
 #include <SimpleJTAG/phy.h>
 #include <util/delay.h>
 
+#include "profile.h"
 #include "sinowealth/phy.h"
+#include "sinowealth/sequence.h"
 
 namespace {
   using namespace config;
@@ -55,10 +57,22 @@ namespace {
   }
 
   static inline bool vref() { return vref::pin & _BV(vref::index); }
+
+  /** Pin writers for sequence::entry(). */
+  struct Lines {
+    static void tck(bool state) { ::tck(state); }
+    static void tms(bool state) { ::tms(state); }
+    static void tdi(bool state) { ::tdi(state); }
+  };
 } // namespace
 
 namespace sinowealth {
 
+void Phy::init(bool wait_vref) {
+  timing::dispatch([this, wait_vref](auto t) { init<decltype(t)>(wait_vref); });
+}
+
+template <typename Timing>
 void Phy::init(bool wait_vref) {
   // skip if already initialized
   if (_mode != Mode::NOT_INITIALIZED) return;
@@ -78,50 +92,32 @@ void Phy::init(bool wait_vref) {
     PORTB &= ~_BV(5);  // LED off
   }
 
+  profile::Scope scope(profile::Phase::PHY_INIT);
+
   // Enable outputs
   SimpleJTAG::Phy::init();
-  ::tck(true);
-  ::tdi(true);
-  ::tms(true);
-
-  _delay_us(500);
-  ::tck(false);
-  _delay_us(1);
-  ::tck(true);
-  _delay_us(50);
-
-  for (uint8_t n = 0; n < 165; ++n) {
-    ::tms(false);
-    _delay_us(2);
-    ::tms(true);
-    _delay_us(2);
-  }
+  sequence::entry<Timing, Lines>();
 
-  for (uint8_t n = 0; n < 105; ++n) {
-    ::tdi(false);
-    _delay_us(2);
-    ::tdi(true);
-    _delay_us(2);
-  }
+  _mode = Mode::READY;
+}
 
-  for (uint8_t n = 0; n < 90; ++n) {
-    ::tck(false);
-    _delay_us(2);
-    ::tck(true);
-    _delay_us(2);
-  }
+bool Phy::resume() {
+  if (_mode != Mode::NOT_INITIALIZED) return true;
 
-  for (uint16_t n = 0; n < 25600; ++n) {
-    ::tms(false);
-    _delay_us(2);
-    ::tms(true);
-    _delay_us(2);
-  }
+  gpio_early_setup();
+  if (!::vref()) return false;
 
-  _delay_us(8);
-  ::tms(false);
+  // Levels first so the outputs come up in READY state (TCK high, TMS low)
+  // without an edge the target could clock.
+  tck::port |= _BV(tck::index);
+  tdi::port |= _BV(tdi::index);
+  tck::ddr |= _BV(tck::index);
+  tms::ddr |= _BV(tms::index);
+  tdi::ddr |= _BV(tdi::index);
+  if (tdo_pullup) tdo::port |= _BV(tdo::index);
 
   _mode = Mode::READY;
+  return true;
 }
 
 void Phy::stop() {
@@ -132,6 +128,8 @@ void Phy::stop() {
 Phy::Mode Phy::mode(Mode mode) {
   if (_mode == mode || _mode == Mode::NOT_INITIALIZED) return _mode;
 
+  profile::Scope scope(profile::Phase::PHY_MODE);
+
   // Have to be in ready state to switch modes
   if (_mode != Mode::READY) reset();
 
@@ -144,6 +142,7 @@ Phy::Mode Phy::mode(Mode mode) {
 }
 
 Phy::Mode Phy::reset() {
+  profile::Scope scope(profile::Phase::PHY_RESET);
   // READY mode is held with TCK high and TMS low
   switch (_mode) {
     case Mode::JTAG:
@@ -170,4 +169,7 @@ Phy::Mode Phy::reset() {
   return _mode;
 }
 
+template void Phy::init<timing::Conservative>(bool);
+template void Phy::init<timing::Fast>(bool);
+
 } // namespace sinowealth
@@ -28,10 +28,14 @@ using detail::bit_reverse_16;
 
 // --- CONFIG ---
 
+// AVR is little-endian, so integers go through the byte-span DR in place
+// and the per-bit work stays 8-bit.
+
 uint64_t Tap::CONFIG::operator()(uint64_t data) {
     tap_.IR(uint8_t(0x03));
     uint64_t raw = 0;
-    tap_.DR<64, uint64_t>(data, &raw);
+    tap_.DR(reinterpret_cast<const uint8_t*>(&data),
+            reinterpret_cast<uint8_t*>(&raw), 64);
     return raw;
 }
 
@@ -66,7 +70,8 @@ uint8_t Tap::DEBUG::operator()(uint8_t command) {
 uint32_t Tap::CODESCAN::operator()(uint32_t data) {
     tap_.IR(uint8_t(0x00));
     uint32_t raw = 0;
-    tap_.DR<30, uint32_t>(data, &raw);
+    tap_.DR(reinterpret_cast<const uint8_t*>(&data),
+            reinterpret_cast<uint8_t*>(&raw), 30);
     return raw;
 }
 
@@ -92,10 +97,13 @@ Tap::CODESCAN::fields_t Tap::CODESCAN::operator()(uint16_t address, uint8_t ctrl
 // --- HALT ---
 
 void Tap::HALT::operator()() {
+    // Selecting HALT is itself the action, always scan it
+    tap_.invalidate_ir();
     tap_.IR(uint8_t(0x0C));
 }
 
 void Tap::HALT::operator()(uint8_t opcode) {
+    tap_.invalidate_ir();
     tap_.IR(uint8_t(0x0C));
     tap_.DR<8>(bit_reverse_8(opcode));
 }
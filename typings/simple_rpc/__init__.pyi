@@ -2,12 +2,17 @@
 
 from typing import Sequence
 
+from serial import Serial
+
 class Interface:
     """SimpleRPC interface for SimpleJTAG Arduino firmware.
 
     Provides RPC methods for JTAG and ICP operations on SinoWealth MCUs.
     """
 
+    _connection: Serial
+    """Underlying serial port, used for raw data that follows some calls."""
+
     def __init__(self, port: str, baudrate: int = 115200) -> None:
         """Connect to SimpleJTAG device.
 
@@ -22,6 +27,17 @@ class Interface:
         """Initialize SinoWealth diagnostics mode."""
         ...
 
+    def phy_attach(self) -> bool:
+        """Attach to a target already in diagnostic mode.
+
+        Probes ICP, then JTAG, and runs the full entry waveform only if
+        neither answers.
+
+        Returns:
+            True if the entry waveform was skipped.
+        """
+        ...
+
     def phy_reset(self) -> bool:
         """Reset PHY to READY state.
 
@@ -34,6 +50,94 @@ class Interface:
         """Sets JTAG ping to Hi-Z, will require target power cycle to use JTAG again."""
         ...
 
+    def phy_set_clock(self, loops: int) -> None:
+        """Set TCK half-period.
+
+        Args:
+            loops: 3-cycle delay loop iterations, 0 = fastest.
+        """
+        ...
+
+    def phy_get_clock(self) -> int:
+        """Get TCK half-period.
+
+        Returns:
+            3-cycle delay loop iterations.
+        """
+        ...
+
+    def phy_set_timing(self, profile: int) -> bool:
+        """Select the waveform timing profile.
+
+        Args:
+            profile: 0 = conservative, 1 = fast.
+
+        Returns:
+            True if active. Once initialized the profile is verified via ICP
+            readback and a failure falls back to conservative.
+        """
+        ...
+
+    def phy_get_timing(self) -> int:
+        """Get the waveform timing profile.
+
+        Returns:
+            Profile ID.
+        """
+        ...
+
+    # Link
+    def link_set_baud(self, baud: int) -> bool:
+        """Switch the UART baud rate once this response has been sent.
+
+        Args:
+            baud: 115200, 250000, 500000, 1000000 or 2000000.
+
+        Returns:
+            True if the rate is supported and will be applied.
+        """
+        ...
+
+    def buffer_capacity(self) -> int:
+        """Size of the static transfer buffer.
+
+        Returns:
+            Bytes available to buffered reads and writes.
+        """
+        ...
+
+    def link_headroom(self) -> int:
+        """Smallest free RAM between heap and stack since boot.
+
+        Returns:
+            Bytes never touched by the heap or the stack.
+        """
+        ...
+
+    # Session
+    def session_open(self) -> bool:
+        """Keep the active mode between calls until session_close.
+
+        ICP/JTAG mode is then only re-entered when it changes, or
+        re-checked after the link has been idle for a while.
+
+        Returns:
+            True if the PHY is initialized.
+        """
+        ...
+
+    def session_close(self) -> None:
+        """End the session and reset PHY to READY state."""
+        ...
+
+    def pipeline_run(self) -> None:
+        """Execute tagged request frames sent after the call until END.
+
+        Each request and response frame starts with a sequence ID, see
+        include/pipeline.h and sinojtag.pipeline.
+        """
+        ...
+
     # TAP layer
     def tap_init(self) -> None:
         """Initialize JTAG interface."""
@@ -75,13 +179,25 @@ class Interface:
 
         Args:
             out: Value to shift out.
-            bits: Bit width (4, 8, 16, 23, or 32).
+            bits: Bit width, 1 to 32.
 
         Returns:
             Captured value shifted in.
         """
         ...
 
+    def tap_dr_bytes(self, out: Sequence[int], bits: int) -> Sequence[int]:
+        """Shift a data register of any width.
+
+        Args:
+            out: Value bytes, LSB first.
+            bits: Bit width, at most 8 per byte of out.
+
+        Returns:
+            Captured bytes, LSB first.
+        """
+        ...
+
     def tap_bypass(self) -> None:
         """Select BYPASS register."""
         ...
@@ -102,6 +218,26 @@ class Interface:
         """
         ...
 
+    def tap_codescan_read_block(self, address: int, length: int) -> None:
+        """Read flash via pipelined CODESCAN, a bulk frame follows the call.
+
+        Args:
+            address: 16-bit flash address.
+            length: Number of bytes, clamped to the end of flash.
+        """
+        ...
+
+    def tap_batch(self, program: Sequence[int]) -> Sequence[int]:
+        """Run a scan program in one call.
+
+        Args:
+            program: Encoded scan ops, see sinojtag.scan.
+
+        Returns:
+            Status byte (0 = OK) followed by the captured values.
+        """
+        ...
+
     # ICP layer
     def icp_init(self) -> None:
         """Initialize ICP interface."""
@@ -115,18 +251,128 @@ class Interface:
         """
         ...
 
+    def icp_calibrate(self) -> int:
+        """Find the fastest reliable TCK rate via ICP readback and apply it.
+
+        Returns:
+            Delay loops selected, 255 if no rate passed.
+        """
+        ...
+
     def icp_read(self, address: int, size: int) -> Sequence[int]:
         """Read flash memory via ICP.
 
         Args:
             address: 16-bit flash address.
-            size: Number of bytes to read (8-bit).
+            size: Number of bytes to read, at most buffer_capacity().
 
         Returns:
             Sequence of bytes read from flash.
         """
         ...
 
+    def icp_read_stream(self, address: int, length: int) -> None:
+        """Stream flash memory via ICP in a single session.
+
+        Exactly `length` raw bytes (clamped to the end of flash) follow
+        the call on the serial connection.
+
+        Args:
+            address: 16-bit flash address.
+            length: Number of bytes to read (32-bit).
+        """
+        ...
+
+    def icp_bulk_read(self, address: int, length: int) -> None:
+        """Read flash memory via ICP as a bulk frame.
+
+        A frame (see sinojtag.frame) with up to `length` bytes follows
+        the call on the serial connection.
+
+        Args:
+            address: 16-bit flash address.
+            length: Number of bytes (16-bit), clamped to the end of flash.
+        """
+        ...
+
+    def icp_bulk_write(self, address: int) -> None:
+        """Write a bulk frame to previously erased flash.
+
+        The host sends the frame right after the call and the device
+        answers with a single status byte.
+
+        Args:
+            address: 16-bit flash address.
+        """
+        ...
+
+    def icp_read_sector(self, address: int) -> None:
+        """Read a 1K flash sector via ICP as a bulk frame following the call.
+
+        Args:
+            address: 16-bit address within the sector.
+        """
+        ...
+
+    def icp_write_sector(self, address: int) -> None:
+        """Write a 1K bulk frame to a previously erased sector.
+
+        The host sends the frame right after the call and the device
+        answers with a single status byte.
+
+        Args:
+            address: 16-bit address within the sector.
+        """
+        ...
+
+    def icp_write_stream(self, address: int) -> None:
+        """Program a credit-paced bulk frame to previously erased flash.
+
+        The host streams the frame after the call, keeping at most the
+        stream window ahead of the CREDIT bytes returned by the device,
+        which finishes with a single status byte.
+
+        Args:
+            address: 16-bit flash address.
+        """
+        ...
+
+    def icp_crc(self, address: int, length: int) -> int:
+        """CRC-32 of a flash range, computed on the device.
+
+        Args:
+            address: 16-bit flash address.
+            length: Number of bytes (32-bit), clamped to the end of flash.
+
+        Returns:
+            CRC-32, identical to zlib.crc32 of the data.
+        """
+        ...
+
+    def icp_crc_sectors(self, address: int, count: int) -> Sequence[int]:
+        """CRC-32 of each 1K sector, computed on the device.
+
+        Args:
+            address: 16-bit address within the first sector.
+            count: Number of sectors, clamped to the end of flash.
+
+        Returns:
+            CRC-32 per sector, identical to zlib.crc32.
+        """
+        ...
+
+    def icp_blank_check(self, address: int, length: int) -> bool:
+        """Check a flash range reads all 0xFF.
+
+        Args:
+            address: 16-bit flash address.
+            length: Number of bytes (32-bit), clamped to the end of flash.
+
+        Returns:
+            True if every byte is 0xFF, stops at the first that isn't.
+        """
+        ...
+
     def icp_erase(self, address: int) -> bool:
         """Erase a sector of flash memory.
 
@@ -138,6 +384,95 @@ class Interface:
         """
         ...
 
+    def icp_erase_timed(self, address: int) -> int:
+        """Erase a sector of flash memory and measure how long it took.
+
+        Args:
+            address: 16-bit flash address.
+
+        Returns:
+            Erase time in ms, 65535 if the erase failed.
+        """
+        ...
+
+    def icp_erase_range(self, address: int, count: int) -> Sequence[int]:
+        """Erase consecutive sectors in one session.
+
+        Args:
+            address: 16-bit address within the first sector.
+            count: Number of sectors, clamped to the end of flash.
+
+        Returns:
+            Erase time in ms per sector. Stops after the first failure,
+            which is reported as 65535.
+        """
+        ...
+
+    def icp_read_rle(self, address: int, length: int) -> None:
+        """Read flash as run-length encoded bulk frames, ended by an empty frame.
+
+        Args:
+            address: 16-bit flash address.
+            length: Number of bytes (32-bit), clamped to the end of flash.
+        """
+        ...
+
+    def icp_write_rle(self, address: int) -> None:
+        """Program a run-length encoded bulk frame sent after the call.
+
+        Runs of 0xFF are skipped, so the range must be erased.
+
+        Args:
+            address: 16-bit flash address of the first decoded byte.
+        """
+        ...
+
+    def icp_write_verify(self, address: int) -> None:
+        """Program a bulk frame sent after the call and read it back in the same session.
+
+        Answered by a frame of a status byte and the u16 offset of the
+        first mismatch, 65535 if the readback matched.
+
+        Args:
+            address: 16-bit flash address.
+        """
+        ...
+
+    def icp_read_image(self, bank_size: int, banks: int, custom_size: int) -> None:
+        """Read main flash bank by bank then the custom block in one session.
+
+        Bulk frames follow the call, ended by an empty frame.
+
+        Args:
+            bank_size: Bytes per XPAGE bank (32-bit), at most 64K.
+            banks: Number of banks.
+            custom_size: Custom block bytes, 0 to skip it.
+        """
+        ...
+
+    def icp_write_region(self, block: int, bank: int, address: int) -> None:
+        """Program a credit-paced bulk frame sent after the call into a block and bank.
+
+        Args:
+            block: 0 for main flash, 1 for the custom block.
+            bank: XPAGE bank.
+            address: 16-bit address within the block.
+        """
+        ...
+
+    def icp_erase_region(self, block: int, bank: int, address: int) -> int:
+        """Erase a sector of a block and bank.
+
+        Args:
+            block: 0 for main flash, 1 for the custom block.
+            bank: XPAGE bank.
+            address: 16-bit address within the block.
+
+        Returns:
+            Erase time in ms, 65535 if the erase failed.
+        """
+        ...
+
     def icp_write(self, address: int, buffer: Sequence[int]) -> bool:
         """Write data to flash.
 
@@ -148,3 +483,92 @@ class Interface:
         Returns:
             True if write successful.
         """
+
+    # Gang layer, only with SINOJTAG_GANG firmware
+    def gang_init(self) -> None:
+        """Initialize SinoWealth diagnostics mode on every gang site."""
+        ...
+
+    def gang_stop(self) -> None:
+        """Set gang pins to Hi-Z."""
+        ...
+
+    def gang_sites(self) -> int:
+        """Number of gang sites.
+
+        Returns:
+            Sites wired to the programmer.
+        """
+        ...
+
+    def gang_verify(self) -> int:
+        """Perform readback test on every site.
+
+        Returns:
+            Mask of sites that passed, bit n for site n.
+        """
+        ...
+
+    def gang_erase(self, address: int) -> int:
+        """Erase a sector of flash memory on every site.
+
+        Args:
+            address: 16-bit flash address.
+
+        Returns:
+            Mask of sites that reported success.
+        """
+        ...
+
+    def gang_bulk_write(self, address: int) -> None:
+        """Write a bulk frame sent after the call to every site.
+
+        Args:
+            address: 16-bit flash address, previously erased.
+        """
+        ...
+
+    def gang_crc(self, address: int, length: int) -> Sequence[int]:
+        """CRC-32 of a flash range on every site.
+
+        Args:
+            address: 16-bit flash address.
+            length: Number of bytes, clamped to the end of flash.
+
+        Returns:
+            CRC-32 per site, identical to zlib.crc32.
+        """
+        ...
+
+    # Profile counters, only with SINOJTAG_PROFILE firmware
+    def stats_get(self) -> Sequence[int]:
+        """Profile counters since start or stats_reset.
+
+        Returns:
+            F_CPU, then cycles and calls per phase, see sinojtag.stats.
+        """
+        ...
+
+    def stats_reset(self) -> None:
+        """Zero the profile counters."""
+        ...
+
+    # Loopback, only with SINOJTAG_BENCH firmware
+    def bench_read(self, length: int, shift: bool) -> None:
+        """Send a synthetic bulk frame following the call.
+
+        Args:
+            length: Payload bytes.
+            shift: Clock every byte through the ICP shifter, needs the PHY
+                uninitialized. An empty frame answers otherwise.
+        """
+        ...
+
+    def bench_write(self, shift: bool) -> None:
+        """Receive and discard a bulk frame sent after the call.
+
+        Args:
+            shift: Clock every byte through the ICP shifter, needs the PHY
+                uninitialized.
+        """
+        ...